@@ -30,11 +30,17 @@
 
  #include <linux/timer.h>
  #include <linux/jiffies.h>
+#include <linux/mm.h>
+#include <linux/vmalloc.h>
+#include <linux/poll.h>
+#include <linux/wait.h>
 
 typedef signed int		int32 ;
 typedef unsigned int	uint32 ;
 typedef unsigned char	uint8 ;
 
+#include "whring.h"
+
 #define TIMEOUT100ms	100 		// milliseconds in a timer tick
 
 #define DEVICE_NAME 	VERSION 	///< The device will appear at /dev/winterhill2v40 using this value
@@ -165,20 +171,15 @@ static volatile uint32	spiBtxcount ;
 static volatile uint32	spiBrxcount ;
 static volatile int		spihandled ;
 
-#define RXBUFFERSIZE	192						// 188 byte packet + 4 status
-#define MAXRXBUFFERS	4096
+#define RXBUFFERSIZE	WHRING_PACKETSIZE		// 188 byte packet + 4 status
 
-static volatile uint8 	rxbuffersA [MAXRXBUFFERS] [RXBUFFERSIZE] ;
-static volatile int		rxbuffindexinA ;
-static volatile int		rxbuffindexoutA ;
-static volatile int		rxbuffersreadyA ;
-static volatile int		rxbuffersfetchedA ;
+// the control page and both rings are in one area that the application may mmap (see whring.h)
 
-static volatile uint8 	rxbuffersB [MAXRXBUFFERS] [RXBUFFERSIZE] ;
-static volatile int		rxbuffindexinB ;
-static volatile int		rxbuffindexoutB ;
-static volatile int		rxbuffersreadyB ;
-static volatile int		rxbuffersfetchedB ;
+static uint8*					whring ;
+static struct whring_control*	whctl ;						// head and tail counts for both rings
+static volatile uint8*			rxbuffersA ;				// packets from PIC_A
+static volatile uint8*			rxbuffersB ;				// packets from PIC_B
+static DECLARE_WAIT_QUEUE_HEAD	(pollqueue) ;				// for poll() on the mmap interface
  
 // The prototype functions for the character driver -- must come before the struct definition
 
@@ -186,6 +187,8 @@ static int     			dev_open	(struct inode *, struct file *);
 static int     			dev_release	(struct inode *, struct file *);
 static ssize_t 			dev_read	(struct file *, char *, size_t, loff_t *);
 static ssize_t 			dev_write	(struct file *, const char *, size_t, loff_t *);
+static int				dev_mmap	(struct file *, struct vm_area_struct *);
+static __poll_t			dev_poll	(struct file *, poll_table *);
 
 static irq_handler_t 	picready_handler 	(unsigned int irq, void *dev_id, struct pt_regs *regs) ;
 static irq_handler_t 	spi_handler 		(unsigned int irq, void *dev_id, struct pt_regs *regs) ;
@@ -206,6 +209,8 @@ static struct file_operations fops =
    .open 	= dev_open,
    .read 	= dev_read,
    .write 	= dev_write,
+   .mmap 	= dev_mmap,
+   .poll 	= dev_poll,
    .release = dev_release,
 } ;
 
@@ -251,6 +256,19 @@ static int __init winterhill_init (void)
       return (majorNumber) ;
    }
    printk (KERN_INFO "winterhill: registered correctly with major number %d\n", majorNumber);
+
+// Allocate the packet rings so that they can be mapped into user space
+
+   whring = vmalloc_user (WHRING_MMAPSIZE) ;
+   if (whring == NULL)
+   {
+      unregister_chrdev (majorNumber, DEVICE_NAME);
+      printk (KERN_ALERT "winterhill failed to allocate the packet rings\n");
+      return (-ENOMEM) ;
+   }
+   whctl 		= (struct whring_control*) whring ;
+   rxbuffersA 	= whring + WHRING_CONTROLSIZE ;
+   rxbuffersB 	= whring + WHRING_CONTROLSIZE + WHRING_RINGSIZE ;
  
 // Register the device class
 
@@ -258,6 +276,7 @@ static int __init winterhill_init (void)
    if (IS_ERR(winterhillClass))						   		// Check for error and clean up if there is
    {
       unregister_chrdev (majorNumber, DEVICE_NAME);
+      vfree (whring) ;
       printk (KERN_ALERT "Failed to register device class\n");
       return (PTR_ERR(winterhillClass));          			// Correct way to return an error on a pointer
    }
@@ -270,6 +289,7 @@ static int __init winterhill_init (void)
    {               											// Clean up if there is an error
       class_destroy (winterhillClass);           			// Repeated code but the alternative is goto statements
       unregister_chrdev (majorNumber, DEVICE_NAME);
+      vfree (whring) ;
       printk (KERN_ALERT "Failed to create the device\n");
       return (PTR_ERR(winterhillDevice));
    }
@@ -286,14 +306,12 @@ static int __init winterhill_init (void)
 	deviceopen 			= 0 ;
 	spiAptr 			= 0 ;
 	spiBptr 			= 0 ;
-	rxbuffersreadyA		= 0 ;
-	rxbuffersfetchedA	= 0 ;
-	rxbuffindexinA		= 0 ;
-	rxbuffindexoutA		= 0 ;
-	rxbuffersreadyB		= 0 ;
-	rxbuffersfetchedB	= 0 ;
-	rxbuffindexinB		= 0 ;
-	rxbuffindexoutB		= 0 ;
+	whctl->readyA		= 0 ;
+	whctl->fetchedA		= 0 ;
+	whctl->readyB		= 0 ;
+	whctl->fetchedB		= 0 ;
+	whctl->overrunsA	= 0 ;
+	whctl->overrunsB	= 0 ;
 	spi5interruptnumber = 0 ;
 	timerticks			= 0 ;
 
@@ -326,14 +344,12 @@ static int dev_open (struct inode *inodep, struct file *filep)
 
 	if ((deviceopen == 0) && spi5interruptnumber)		// must first provide the interrupt number via 'write' 
 	{
-		rxbuffindexinA 		= 0 ;
-		rxbuffindexoutA		= 0 ;
-		rxbuffersreadyA		= 0 ;
-		rxbuffersfetchedA	= 0 ;
-		rxbuffindexinB 		= 0 ;
-		rxbuffindexoutB		= 0 ;
-		rxbuffersreadyB		= 0 ;
-		rxbuffersfetchedB	= 0 ;
+		whctl->readyA		= 0 ;
+		whctl->fetchedA		= 0 ;
+		whctl->readyB		= 0 ;
+		whctl->fetchedB		= 0 ;
+		whctl->overrunsA	= 0 ;
+		whctl->overrunsB	= 0 ;
 		spiBptr 			= 0 ;
 		spiAptr 			= 0 ;
 		sleeping_task 		= 0 ;
@@ -465,7 +481,7 @@ static int dev_open (struct inode *inodep, struct file *filep)
  *  send the buffer string to the user and captures any errors.
  *  @param filep A pointer to a file object (defined in linux/fs.h)
  *  @param buffer The pointer to the buffer to which this function writes the data
- *  @param len The length of the b
+ *  @param len The length of the buffer: a multiple of RXBUFFERSIZE; as many ready packets as fit are returned
  *  @param offset The offset if required
 */
 
@@ -474,6 +490,8 @@ static int dev_open (struct inode *inodep, struct file *filep)
    		int 		error_count = 0 ;
 static	int			toggleAB ;
 		int32		temp ;
+		uint32		count ;
+		uint32		maxcount ;
 
 	asm (" dmb") ;
 
@@ -487,13 +505,14 @@ static	int			toggleAB ;
 
 	asm (" dmb") ;
 
-	if (len != RXBUFFERSIZE)						// requested length must be RXBUFFERSIZE
+	if ((len < RXBUFFERSIZE) || (len % RXBUFFERSIZE))		// requested length must be a multiple of RXBUFFERSIZE
 	{
 	   	printk (KERN_INFO "winterhill: len = %d\n", len);
 		return (-1) ;
 	}
+	maxcount = len / RXBUFFERSIZE ;					// the most packets that can be returned
 
-	while ((rxbuffersreadyA == rxbuffersfetchedA) && (rxbuffersreadyB == rxbuffersfetchedB) && (readstatus == 0))
+	while ((whring_count (whctl->readyA, whctl->fetchedA) == 0) && (whring_count (whctl->readyB, whctl->fetchedB) == 0) && (readstatus == 0))
 	{
 		if (sleeping_task == 0)
 		{
@@ -512,33 +531,37 @@ static	int			toggleAB ;
 		return (temp) ;
 	}
 
- 	while (1)
+// return as many packets as are ready, alternating between PIC_A and PIC_B
+
+	count = 0 ;
+ 	while (count < maxcount)
   	{
+		asm (" dmb") ;
+		if ((whring_count (whctl->readyA, whctl->fetchedA) == 0) && (whring_count (whctl->readyB, whctl->fetchedB) == 0))
+		{
+			break ;									// nothing more is ready
+		}
+
 		if ((toggleAB++ & 1) == 0)
 		{
-			if (rxbuffersreadyB != rxbuffersfetchedB)
+			if (whring_count (whctl->readyB, whctl->fetchedB))
 			{
-				error_count = copy_to_user (buffer, (void*)(&rxbuffersB[rxbuffindexoutB]), len) ;
+				error_count = copy_to_user (buffer + count * RXBUFFERSIZE, (void*)whring_packet (rxbuffersB, whctl->fetchedB), RXBUFFERSIZE) ;
 				if (error_count)
 				{
 				   	printk (KERN_INFO "winterhill: error_count B = %d\n", error_count);		
 				}
 				asm (" dmb") ;
 
-				rxbuffersfetchedB++ ;
-				rxbuffindexoutB++ ;
-				if (rxbuffindexoutB >= MAXRXBUFFERS)
-				{
-					rxbuffindexoutB = 0 ;
-				}
-				break ;
+				whctl->fetchedB++ ;
+				count++ ;
 			}
 		}	
 		else 
 		{
-			if (rxbuffersreadyA != rxbuffersfetchedA)
+			if (whring_count (whctl->readyA, whctl->fetchedA))
 			{
-				error_count = copy_to_user (buffer, (void*)(&rxbuffersA[rxbuffindexoutA]), len) ;
+				error_count = copy_to_user (buffer + count * RXBUFFERSIZE, (void*)whring_packet (rxbuffersA, whctl->fetchedA), RXBUFFERSIZE) ;
 				if (error_count)
 				{
 				   	printk (KERN_INFO "winterhill: error_count A = %d\n", error_count);		
@@ -546,20 +569,15 @@ static	int			toggleAB ;
 	
 				asm (" dmb") ;
 	
-				rxbuffersfetchedA++ ;
-				rxbuffindexoutA++ ;
-				if (rxbuffindexoutA >= MAXRXBUFFERS)
-				{
-					rxbuffindexoutA = 0 ;
-				}
-				break ;
+				whctl->fetchedA++ ;
+				count++ ;
 			}
 		}
 	}
 	
 	asm (" dmb") ;
 		
-	return (RXBUFFERSIZE) ;
+	return (count * RXBUFFERSIZE) ;
 }
  
 /*
@@ -588,6 +606,77 @@ static ssize_t dev_write (struct file *filep, const char *buffer, size_t len, lo
 }
 
  
+/*
+ *  @brief This function is called when user space maps the device. The control page (offset 0)
+ *  may be mapped read / write so that the reader can update its tail counts; the two packet rings
+ *  (offset WHRING_CONTROLSIZE) may only be mapped read only. See whring.h for the layout.
+ *  @param filep A pointer to a file object
+ *  @param vma The user space area to be mapped
+*/
+
+static int dev_mmap (struct file *filep, struct vm_area_struct *vma)
+{
+	unsigned long		offset ;
+	unsigned long		size ;
+
+	offset = vma->vm_pgoff << PAGE_SHIFT ;
+	size   = vma->vm_end - vma->vm_start ;
+
+	if ((offset == 0) && (size == WHRING_CONTROLSIZE))
+	{
+	}
+	else if ((offset == WHRING_CONTROLSIZE) && (size == 2 * WHRING_RINGSIZE))
+	{
+		if (vma->vm_flags & VM_WRITE)
+		{
+		   	printk (KERN_INFO "winterhill: the packet rings can only be mapped read only\n");
+			return (-EPERM) ;
+		}
+		vma->vm_flags &= ~VM_MAYWRITE ;
+	}
+	else
+	{
+	   	printk (KERN_INFO "winterhill: mmap offset = %lu size = %lu\n", offset, size);
+		return (-EINVAL) ;
+	}
+
+	return (remap_vmalloc_range (vma, whring, vma->vm_pgoff)) ;
+}
+
+
+/*
+ *  @brief This function is called by poll() and select() when the packet rings are used via mmap.
+ *  The device is readable when either ring holds packets that have not been fetched.
+ *  @param filep A pointer to a file object
+ *  @param wait The poll table
+*/
+
+static __poll_t dev_poll (struct file *filep, poll_table *wait)
+{
+	__poll_t		mask ;
+
+	poll_wait (filep, &pollqueue, wait) ;
+
+	asm (" dmb") ;
+
+	mask = 0 ;
+	if (spi5interruptnumber == 0)
+	{
+		mask |= EPOLLERR ;
+	}
+	if (readstatus == -3)
+	{
+		mask |= EPOLLHUP ;
+	}
+	if (whring_count (whctl->readyA, whctl->fetchedA) || whring_count (whctl->readyB, whctl->fetchedB))
+	{
+		mask |= EPOLLIN | EPOLLRDNORM ;
+	}
+
+	return (mask) ;
+}
+
+ 
 /*
  * @brief The device release function that is called whenever the device is closed/released by
  *  the userspace program
@@ -600,6 +689,7 @@ static int dev_release (struct inode *inodep, struct file *filep)
 	if (deviceopen)
 	{	
 		readstatus = -3 ;
+		wake_up_interruptible (&pollqueue) ;
 		if (sleeping_task)
 		{
 			sleeping_task2 = sleeping_task ;
@@ -677,6 +767,7 @@ static int dev_release (struct inode *inodep, struct file *filep)
  	{
 	   	printk (KERN_INFO "winterhill: Device is open\n");
 		readstatus = -3 ;
+		wake_up_interruptible (&pollqueue) ;
 		if (sleeping_task)
 		{	
 		   	printk (KERN_INFO "winterhill: Sleeping task active\n");
@@ -726,6 +817,7 @@ static int dev_release (struct inode *inodep, struct file *filep)
    	class_unregister	(winterhillClass);            		       	// unregister the device class
    	class_destroy		(winterhillClass);                         	// remove the device class
    	unregister_chrdev	(majorNumber, DEVICE_NAME);             	// unregister the major number
+   	vfree				(whring) ;										// free the packet rings
    	printk				(KERN_INFO "winterhill: Driver removed from the kernel\n") ;
 }
 
@@ -751,14 +843,16 @@ static irq_handler_t picready_handler (unsigned int irq, void *dev_id, struct pt
 			spiAtxcount 	= 192 ;
 			spiArxcount 	= 192 ;
 	 		asm (" dmb") ;	 		
-			spiAptr			= rxbuffersA [rxbuffindexinA] ;
-			spiAstart		= spiAptr ;
-			memset ((void*)spiAptr, 0xcd, RXBUFFERSIZE) ; /////////
-			rxbuffindexinA  ++ ;
-			if (rxbuffindexinA >= MAXRXBUFFERS)
+			if (whring_count (whctl->readyA, whctl->fetchedA) < WHRING_PACKETS)
 			{
-				rxbuffindexinA = 0 ;
+				spiAptr		= whring_packet (rxbuffersA, whctl->readyA) ;
 			}
+			else
+			{
+				spiAptr		= spiAbuff ;						// ring full: read the packet and drop it
+			}
+			spiAstart		= spiAptr ;
+			memset ((void*)spiAptr, 0xcd, RXBUFFERSIZE) ; /////////
 				
 	 		asm (" dmb") ;
 			gpio [GPCLR0]   = SSMASK_A ;						// SS low
@@ -776,14 +870,16 @@ static irq_handler_t picready_handler (unsigned int irq, void *dev_id, struct pt
 			spiBtxcount 	= 192 ;
 			spiBrxcount 	= 192 ;
  			asm (" dmb") ;
-			spiBptr			= rxbuffersB [rxbuffindexinB] ;
-			spiBstart		= spiBptr ;
-			memset ((void*)spiBptr, 0xcd, RXBUFFERSIZE) ; /////////
-			rxbuffindexinB  ++ ;
-			if (rxbuffindexinB >= MAXRXBUFFERS)
+			if (whring_count (whctl->readyB, whctl->fetchedB) < WHRING_PACKETS)
+			{
+				spiBptr		= whring_packet (rxbuffersB, whctl->readyB) ;
+			}
+			else
 			{
-				rxbuffindexinB = 0 ;
+				spiBptr		= spiBbuff ;						// ring full: read the packet and drop it
 			}
+			spiBstart		= spiBptr ;
+			memset ((void*)spiBptr, 0xcd, RXBUFFERSIZE) ; /////////
 
  			asm (" dmb") ;
 			gpio [GPCLR0]  = SSMASK_B ;							// SS low
@@ -854,13 +950,21 @@ static irq_handler_t spi_handler (unsigned int irq, void *dev_id, struct pt_regs
 					spiA[SPI_CS] &= ~TA_SPI ;							// disable transfer
 					asm (" dmb") ;
 					spiAptr = 0 ;
-					rxbuffersreadyA++ ;
+					if (spiAstart == spiAbuff)
+					{
+						whctl->overrunsA++ ;
+					}
+					else
+					{
+						whctl->readyA++ ;
+					}
 					asm (" dmb") ;
 					if (sleeping_task)
 					{
 						wake_up_process (sleeping_task) ;
 						sleeping_task = 0 ;
 					}
+					wake_up_interruptible (&pollqueue) ;
 		 			asm (" dmb") ;
 					gpio[GPSET0] = SSMASK_A ;							// SS high
 					stateA = 1 ;
@@ -912,13 +1016,21 @@ static irq_handler_t spi_handler (unsigned int irq, void *dev_id, struct pt_regs
 					spiB[SPI_CS] &= ~TA_SPI ;							// disable transfer
 					asm (" dmb") ;
 					spiBptr = 0 ;
-					rxbuffersreadyB++ ;
+					if (spiBstart == spiBbuff)
+					{
+						whctl->overrunsB++ ;
+					}
+					else
+					{
+						whctl->readyB++ ;
+					}
 					asm (" dmb") ;
 					if (sleeping_task)
 					{
 						wake_up_process (sleeping_task) ;
 						sleeping_task = 0 ;
 					}
+					wake_up_interruptible (&pollqueue) ;
 					asm (" dmb") ;
 					gpio[GPSET0] = SSMASK_B ;							// SS high
 					stateB = 1 ;
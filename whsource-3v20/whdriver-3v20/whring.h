@@ -0,0 +1,61 @@
+// winterhill packet ring buffers shared between whdriver-3v20 and the main application
+
+#ifndef WHRING_H
+#define WHRING_H
+
+/*
+	The driver allocates one area of WHRING_MMAPSIZE bytes:
+
+		offset 0						control page: head and tail counts for both rings
+		offset WHRING_CONTROLSIZE		ring A: WHRING_PACKETS packets from PIC_A
+		. . .  + WHRING_RINGSIZE		ring B: WHRING_PACKETS packets from PIC_B
+
+	The control page may be mapped read / write; the rings may only be mapped read only.
+
+	The counts are free running.  The driver increments 'ready' when a packet has been
+	written; the reader increments 'fetched' when it has finished with a packet.
+	When a ring is full the driver still reads the packet from its PIC, but drops it
+	and increments 'overruns' instead of 'ready'.
+*/
+
+#define WHRING_PACKETSIZE		192							// 188 byte packet + 4 status
+#define WHRING_PACKETS			4096						// packets in each ring; must be a power of 2
+#define WHRING_CONTROLSIZE		4096						// one page
+#define WHRING_RINGSIZE			(WHRING_PACKETS * WHRING_PACKETSIZE)
+#define WHRING_MMAPSIZE			(WHRING_CONTROLSIZE + 2 * WHRING_RINGSIZE)
+
+struct whring_control
+{
+	volatile uint32		readyA ;							// head of ring A, written by the driver
+	volatile uint32		readyB ;							// head of ring B, written by the driver
+	volatile uint32		fetchedA ;							// tail of ring A, written by the reader
+	volatile uint32		fetchedB ;							// tail of ring B, written by the reader
+	volatile uint32		overrunsA ;							// packets dropped because ring A was full
+	volatile uint32		overrunsB ;							// packets dropped because ring B was full
+} ;
+
+
+// number of packets waiting in a ring
+
+static inline uint32 whring_count (uint32 ready, uint32 fetched)
+{
+	return (ready - fetched) ;
+}
+
+
+// position in a ring of a free running count
+
+static inline uint32 whring_index (uint32 count)
+{
+	return (count & (WHRING_PACKETS - 1)) ;
+}
+
+
+// address of a packet in a ring
+
+static inline volatile uint8* whring_packet (volatile uint8* ring, uint32 count)
+{
+	return (ring + whring_index (count) * WHRING_PACKETSIZE) ;
+}
+
+#endif
@@ -0,0 +1,143 @@
+// winterhill MPEG-2 CRC32 for PSI sections
+// shared by winterhill-3v20 and the crcbench check program
+
+#include <stdio.h>
+#include <string.h>
+#include "crc32.h"
+
+#if defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#ifndef HWCAP_CRC32
+#define HWCAP_CRC32			(1 << 7)				// arm64 AT_HWCAP
+#endif
+#ifndef HWCAP2_CRC32
+#define HWCAP2_CRC32		(1 << 4)				// arm AT_HWCAP2
+#endif
+#endif
+
+			uint32				crc32hardware ;			// the ARMv8 CRC32 instructions are used
+static		uint32				crc32tables 			[8][256] ;				// slice-by-8 CRC32 tables
+
+
+// build the tables for the slice-by-8 MPEG-2 CRC32
+// and use the ARMv8 CRC32 instructions instead if the CPU has them
+
+void crc32_init (void)
+{
+	uint32		x ;
+	uint32		y ;
+	uint32		crc ;
+
+	for (x = 0 ; x < 256 ; x++)
+	{
+		crc = x << 24 ;
+		for (y = 0 ; y < 8 ; y++)
+		{
+			crc = (crc & 0x80000000) ? (crc << 1) ^ 0x04c11db7 : crc << 1 ;
+		}
+		crc32tables [0][x] = crc ;
+	}
+	for (x = 0 ; x < 256 ; x++)
+	{
+		for (y = 1 ; y < 8 ; y++)
+		{
+			crc = crc32tables [y-1][x] ;
+			crc32tables [y][x] = (crc << 8) ^ crc32tables [0][crc >> 24] ;
+		}
+	}
+
+	crc32hardware = 0 ;
+#if defined(__ARM_FEATURE_CRC32)
+#if defined(__aarch64__)
+	if (getauxval (AT_HWCAP) & HWCAP_CRC32)
+#else
+	if (getauxval (AT_HWCAP2) & HWCAP2_CRC32)
+#endif
+	{
+		crc32hardware = 1 ;
+	}
+#endif
+	printf ("CRC32: %s\r\n", crc32hardware ? "ARMv8 CRC instructions" : "slice-by-8 tables") ;
+}
+
+
+#if defined(__ARM_FEATURE_CRC32)
+
+// reverse the bit order in a word
+
+static inline uint32 crc32_rbit (uint32 x)
+{
+#if defined(__aarch64__)
+	asm ("rbit %w0, %w1" : "=r" (x) : "r" (x)) ;
+#else
+	asm ("rbit %0, %1" : "=r" (x) : "r" (x)) ;
+#endif
+	return (x) ;
+}
+
+
+// the CRC32 instructions calculate the bit reflected CRC with the same polynomial,
+// so the data and the result are bit reversed to give the MPEG-2 CRC
+
+uint32 calculateCRC32_arm (uint8* data, uint32 dataLength)
+{
+	uint32		crc ;
+	uint32		word ;
+
+	crc = 0xffffffff ;
+	while (dataLength >= 4)
+	{
+		memcpy (&word, data, 4) ;
+		crc = __crc32w (crc, __builtin_bswap32 (crc32_rbit (word))) ;
+		data += 4 ;
+		dataLength -= 4 ;
+	}
+	while (dataLength--)
+	{
+		crc = __crc32b (crc, crc32_rbit (*data++) >> 24) ;
+	}
+	return (crc32_rbit (crc)) ;
+}
+
+#endif
+
+
+// MPEG-2 CRC32, slice-by-8
+
+uint32 calculateCRC32_table (uint8* data, uint32 dataLength)
+{
+	uint32		crc ;
+
+	crc = 0xffffffff ;
+	while (dataLength >= 8)
+	{
+		crc ^= ((uint32)data[0] << 24) | (data[1] << 16) | (data[2] << 8) | data[3] ;
+		crc  = crc32tables [7][crc >> 24] ^ crc32tables [6][(crc >> 16) & 0xff] ^
+			   crc32tables [5][(crc >> 8) & 0xff] ^ crc32tables [4][crc & 0xff] ^
+			   crc32tables [3][data[4]] ^ crc32tables [2][data[5]] ^
+			   crc32tables [1][data[6]] ^ crc32tables [0][data[7]] ;
+		data += 8 ;
+		dataLength -= 8 ;
+	}
+	while (dataLength--)
+	{
+		crc = (crc << 8) ^ crc32tables [0][(crc >> 24) ^ *data++] ;
+	}
+	return (crc) ;
+}
+
+
+// MPEG-2 CRC32 with the ARMv8 CRC32 instructions if the CPU has them, otherwise slice-by-8
+// over a whole section including its CRC, the result is 0 if the CRC is correct
+
+uint32 calculateCRC32 (uint8* data, uint32 dataLength)
+{
+#if defined(__ARM_FEATURE_CRC32)
+	if (crc32hardware)
+	{
+		return (calculateCRC32_arm (data, dataLength)) ;
+	}
+#endif
+	return (calculateCRC32_table (data, dataLength)) ;
+}
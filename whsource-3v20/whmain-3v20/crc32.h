@@ -0,0 +1,17 @@
+// winterhill MPEG-2 CRC32 for PSI sections
+
+#ifndef CRC32_H
+#define CRC32_H
+
+#include "globals.h"
+
+extern	uint32		crc32hardware ;							// the ARMv8 CRC32 instructions are used
+
+		void		crc32_init					(void) ;
+		uint32		calculateCRC32				(uint8*, uint32) ;
+		uint32		calculateCRC32_table		(uint8*, uint32) ;
+#if defined(__ARM_FEATURE_CRC32)
+		uint32		calculateCRC32_arm			(uint8*, uint32) ;
+#endif
+
+#endif
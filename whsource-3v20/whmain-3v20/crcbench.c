@@ -0,0 +1,174 @@
+// check and benchmark of the MPEG-2 CRC32 in crc32.c
+//
+// calculateCRC32, calculateCRC32_table (slice-by-8) and, where the CPU has them,
+// calculateCRC32_arm (ARMv8 CRC32 instructions) are compared with the original
+// bit serial calculation on random buffers, then timed on 188 byte sections
+//
+// build and run with:	make crcbench && ./crcbench
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "crc32.h"
+
+#define CHECKS			20000						// random buffers checked
+#define MAXLENGTH		4096						// longest of them
+#define SECTIONLENGTH	188							// length timed
+#define SECTIONS		200000						// sections timed for each calculation
+
+typedef uint32 (*crcfunction) (uint8*, uint32) ;
+
+static uint8	buff [MAXLENGTH + 4] ;
+
+
+// the calculation used before the slice-by-8 tables
+
+static uint32 crc32_serial (uint8* data, uint32 dataLength)
+{
+    uint32      crc ;
+    uint32      poly, temp, temp2, temp4, bit31 ;
+	uint32		x ;
+
+	crc = 0xffffffff ;
+	poly = 0x04c11db7 ;
+   	while (dataLength-- > 0)
+	{
+		temp4 = poly ;
+		temp2 = (crc >> 24) ^ *data ;
+		temp = 0 ;
+		for (x = 0 ; x < 8 ; x++)
+		{
+			if ((temp2 >> x) & 1)
+			{
+				temp ^= temp4 ;
+			}
+			bit31 = temp4 >> 31 ;
+			temp4 <<= 1 ;
+			if (bit31)
+			{
+				temp4 ^= poly ;
+			}
+		}
+		crc = (crc<<8) ^ temp ;
+		data++ ;
+   	}
+    return crc ;
+}
+
+
+static uint64_t nanoseconds (void)
+{
+	struct timespec		tp ;
+
+	clock_gettime (CLOCK_MONOTONIC, &tp) ;
+	return ((uint64_t) tp.tv_sec * 1000000000 + tp.tv_nsec) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 compare a CRC calculation with the bit serial one on random buffers
+//@	 a buffer followed by its CRC, most significant byte first as in a section, must give 0
+//@
+//@	 Calling:	name		for the report
+//@				crc			the calculation
+//@
+//@	 Return:	number of errors
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+static uint32 crc_check (char* name, crcfunction crc)
+{
+	uint32		n ;
+	uint32		x ;
+	uint32		length ;
+	uint32		expected ;
+	uint32		errors ;
+
+	errors = 0 ;
+	for (n = 0 ; n < CHECKS ; n++)
+	{
+		length = n < 64 ? n : (uint32) rand () % (MAXLENGTH + 1) ;			// all the short tails, then random
+		for (x = 0 ; x < length ; x++)
+		{
+			buff [x] = rand () ;
+		}
+		expected = crc32_serial (buff, length) ;
+		if (crc (buff, length) != expected)
+		{
+			if (errors++ < 4)
+			{
+				printf ("%-8s length %4u: %08x, expected %08x\r\n", name, length, crc (buff, length), expected) ;
+			}
+			continue ;
+		}
+		buff [length]     = expected >> 24 ;
+		buff [length + 1] = expected >> 16 ;
+		buff [length + 2] = expected >> 8 ;
+		buff [length + 3] = expected ;
+		if (crc (buff, length + 4) != 0)
+		{
+			if (errors++ < 4)
+			{
+				printf ("%-8s length %4u: section with its CRC does not give 0\r\n", name, length) ;
+			}
+		}
+	}
+	printf ("%-8s %u random buffers: %s\r\n", name, CHECKS, errors ? "FAIL" : "ok") ;
+	return (errors) ;
+}
+
+
+static void crc_time (char* name, crcfunction crc)
+{
+	uint32		n ;
+	uint32		sum ;
+	uint64_t	start ;
+	uint64_t	elapsed ;
+
+	sum   = 0 ;
+	start = nanoseconds () ;
+	for (n = 0 ; n < SECTIONS ; n++)
+	{
+		buff [0] = n ;
+		sum 	+= crc (buff, SECTIONLENGTH) ;
+	}
+	elapsed = nanoseconds () - start ;
+	printf ("%-8s %7.1f ns per %d byte section %8.1f MB/s   (%08x)\r\n", name,
+		(double) elapsed / SECTIONS, SECTIONLENGTH, (double) SECTIONS * SECTIONLENGTH * 1000 / elapsed, sum) ;
+}
+
+
+int main (void)
+{
+	uint32		errors ;
+
+	crc32_init () ;
+	srand (1) ;
+
+	errors  = 0 ;
+	errors += crc_check ("table", calculateCRC32_table) ;
+#if defined(__ARM_FEATURE_CRC32)
+	if (crc32hardware)
+	{
+		errors += crc_check ("arm", calculateCRC32_arm) ;
+	}
+#endif
+	errors += crc_check ("selected", calculateCRC32) ;
+
+	crc_time ("serial", crc32_serial) ;
+	crc_time ("table", calculateCRC32_table) ;
+#if defined(__ARM_FEATURE_CRC32)
+	if (crc32hardware)
+	{
+		crc_time ("arm", calculateCRC32_arm) ;
+	}
+#endif
+	crc_time ("selected", calculateCRC32) ;
+
+	printf ("%s\r\n", errors ? "CRC CHECK FAILED" : "crc check passed") ;
+	return (errors ? 1 : 0) ;
+}
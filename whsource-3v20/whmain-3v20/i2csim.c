@@ -0,0 +1,242 @@
+// i2csim: the rpi2c register access functions on a simulated I2C bus
+//
+// rpi2c.c is given a file descriptor for /dev/null, and the I2C_RDWR ioctls on it are taken
+// here: each transaction holds the caller for the time it would take on the bus, with a start,
+// the address byte and the data bytes of each message and a stop, and the registers are kept
+// in memory so that what is written can be read back
+// the same registers are accessed one at a time and in bursts, as the info loop reads and
+// stv0910_init_regs writes them, and the rpi2c access counts and time histogram are printed
+//
+// build and run with:	make i2csim && ./i2csim [bus clock in Hz, default 400000]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/syscall.h>
+#include <linux/i2c.h>
+#include "rpi2c.h"
+
+#define SIMREGISTERS		24						// demodulator registers read for each receiver
+#define SIMBURST			8						// . . in bursts of this many
+#define SIMINITREGISTERS	512						// registers written when a demodulator is set up
+#define SIMPASSES			20						// times each pattern is run
+
+static	int			simfd = -1 ;					// the simulated bus
+static	uint32_t	simclock = 400000 ;				// bus clock (Hz)
+static	uint64_t	simbusns ;						// time spent on the bus (ns)
+static	uint8_t		simregs [128][65536] ;			// registers for each 7 bit address
+static	uint32_t	simerrors ;
+
+
+// the PICs are not simulated, so the STV0910 repeaters are left alone
+
+uint8_t nim_set_stv0910_repeaters (bool on)
+{
+	(void) on ;
+	return (0) ;
+}
+
+
+static uint64_t sim_ns (void)
+{
+	struct timespec		tp ;
+
+	clock_gettime (CLOCK_MONOTONIC, &tp) ;
+	return ((uint64_t) tp.tv_sec * 1000000000 + tp.tv_nsec) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 ioctl, taken over for the simulated bus; other file descriptors go to the kernel
+//@
+//@	 the demodulators have 16 bit register addresses, the other devices 8 bit
+//@	 the register address auto-increments, as on the STV0910
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+int ioctl (int fd, unsigned long request, ...)
+{
+	va_list						args ;
+	void*						arg ;
+	struct i2c_rdwr_ioctl_data*	rdwr ;
+	struct i2c_msg*				mp ;
+	uint32_t					n ;
+	uint32_t					x ;
+	uint32_t					bits ;
+	uint32_t					reg ;
+	uint32_t					wide ;
+	uint64_t					until ;
+
+	va_start (args, request) ;
+	arg = va_arg (args, void*) ;
+	va_end (args) ;
+
+	if (fd != simfd || request != I2C_RDWR)
+	{
+		return (syscall (SYS_ioctl, fd, request, arg)) ;
+	}
+
+	rdwr = arg ;
+	bits = 2 ;															// stop, plus the start below
+	reg  = 0 ;
+	for (n = 0 ; n < rdwr->nmsgs ; n++)
+	{
+		mp 	  = &rdwr->msgs [n] ;
+		wide  = (mp->addr << 1) >= NIM_DEMOD_ADDR_A && (mp->addr << 1) <= NIM_DEMOD_ADDR_D ;
+		bits += 1 + 9 * (1 + mp->len) ;									// (repeated) start, address, data, each with its ack
+		if (mp->flags & I2C_M_RD)
+		{
+			for (x = 0 ; x < mp->len ; x++)
+			{
+				mp->buf [x] = simregs [mp->addr & 0x7f][(reg + x) & 0xffff] ;
+			}
+		}
+		else
+		{
+			x = 0 ;
+			if (mp->len > wide)
+			{
+				reg = wide ? (mp->buf[0] << 8) | mp->buf[1] : mp->buf[0] ;
+				x   = wide + 1 ;
+			}
+			for ( ; x < mp->len ; x++)
+			{
+				simregs [mp->addr & 0x7f][reg++ & 0xffff] = mp->buf [x] ;
+			}
+			reg = wide ? (mp->buf[0] << 8) | mp->buf[1] : mp->buf[0] ;
+		}
+	}
+
+	until = sim_ns () + (uint64_t) bits * 1000000000 / simclock ;		// hold the caller for the bus time
+	simbusns += (uint64_t) bits * 1000000000 / simclock ;
+	while (sim_ns () < until)
+	{
+	}
+	return (0) ;
+}
+
+
+static void sim_reset (void)
+{
+	i2caccesses   = 0 ;
+	i2caccesstime = 0 ;
+	simbusns 	  = 0 ;
+	memset (i2chistogram, 0, sizeof(i2chistogram)) ;
+}
+
+
+static void sim_report (char* name, uint64_t start)
+{
+	uint64_t	elapsed ;
+
+	elapsed = sim_ns () - start ;
+	printf ("\r\n%s: %llu us, %llu us of it on the bus\r\n", name,
+		(unsigned long long) elapsed / 1000, (unsigned long long) simbusns / 1000) ;
+	i2c_print_stats () ;
+}
+
+
+int main (int argc, char* argv[])
+{
+	uint32_t	pass ;
+	uint32_t	rx ;
+	uint32_t	n ;
+	uint16_t	reg ;
+	uint8_t		val ;
+	uint8_t		vals [I2CMAXBURST] ;
+	uint64_t	start ;
+static const uint8_t	demods [4] = {NIM_DEMOD_ADDR_A, NIM_DEMOD_ADDR_A, NIM_DEMOD_ADDR_B, NIM_DEMOD_ADDR_B} ;
+static const uint16_t	bases  [4] = {0xf400, 0xf200, 0xf400, 0xf200} ;		// P1 and P2 of each STV0910
+
+	if (argc > 1)
+	{
+		simclock = atoi (argv[1]) ;
+	}
+	simfd = open ("/dev/null", O_RDWR) ;
+	if (simfd < 0 || simclock == 0)
+	{
+		printf ("Cannot set up the simulated bus\r\n") ;
+		return (1) ;
+	}
+	i2c_use_fd (simfd) ;
+	printf ("simulated I2C bus at %u Hz\r\n", simclock) ;
+
+// demodulator set up: registers written one at a time, then in bursts
+
+	sim_reset () ;
+	start = sim_ns () ;
+	for (reg = 0 ; reg < SIMINITREGISTERS ; reg++)
+	{
+		i2c_write_reg16 (NIM_DEMOD_ADDR_A, 0xf000 + reg, reg ^ 0x5a) ;
+	}
+	sim_report ("set up, one register per transaction", start) ;
+
+	sim_reset () ;
+	start = sim_ns () ;
+	for (reg = 0 ; reg < SIMINITREGISTERS ; reg += I2CMAXBURST)
+	{
+		for (n = 0 ; n < I2CMAXBURST ; n++)
+		{
+			vals [n] = (reg + n) ^ 0xa5 ;
+		}
+		i2c_write_block16 (NIM_DEMOD_ADDR_B, 0xf000 + reg, I2CMAXBURST, vals) ;
+	}
+	sim_report ("set up, bursts of I2CMAXBURST", start) ;
+
+// telemetry: the same registers of the 4 receivers read one at a time, then in bursts
+
+	sim_reset () ;
+	start = sim_ns () ;
+	for (pass = 0 ; pass < SIMPASSES ; pass++)
+	{
+		for (rx = 0 ; rx < 4 ; rx++)
+		{
+			for (n = 0 ; n < SIMREGISTERS ; n++)
+			{
+				i2c_read_reg16 (demods [rx], bases [rx] + n, &val) ;
+			}
+		}
+	}
+	sim_report ("telemetry, one register per transaction", start) ;
+
+	sim_reset () ;
+	start = sim_ns () ;
+	for (pass = 0 ; pass < SIMPASSES ; pass++)
+	{
+		for (rx = 0 ; rx < 4 ; rx++)
+		{
+			for (n = 0 ; n < SIMREGISTERS ; n += SIMBURST)
+			{
+				i2c_read_block16 (demods [rx], bases [rx] + n, SIMBURST, vals) ;
+			}
+		}
+	}
+	sim_report ("telemetry, bursts of 8", start) ;
+
+// what was written must read back, one at a time and in bursts
+
+	for (reg = 0 ; reg < SIMINITREGISTERS ; reg++)
+	{
+		i2c_read_reg16 (NIM_DEMOD_ADDR_A, 0xf000 + reg, &val) ;
+		simerrors += val != (uint8_t) (reg ^ 0x5a) ;
+	}
+	for (reg = 0 ; reg < SIMINITREGISTERS ; reg += I2CMAXBURST)
+	{
+		i2c_read_block16 (NIM_DEMOD_ADDR_B, 0xf000 + reg, I2CMAXBURST, vals) ;
+		for (n = 0 ; n < I2CMAXBURST ; n++)
+		{
+			simerrors += vals [n] != (uint8_t) ((reg + n) ^ 0xa5) ;
+		}
+	}
+	printf ("\r\nread back: %s\r\n", simerrors ? "FAIL" : "ok") ;
+	return (simerrors ? 1 : 0) ;
+}
@@ -37,6 +37,13 @@
 #include <netdb.h>
 #include <ifaddrs.h>
 #include <time.h>
+#include <poll.h>
+#include <semaphore.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include "../whdriver-3v20/whring.h"
+#include "crc32.h"
 
 #define CR		13
 #define LF		10
@@ -77,37 +84,89 @@
     9962    OUT         send LM info stream for receiver 2    
     9963    OUT         send LM info stream for receiver 3    
     9964    OUT         send LM info stream for receiver 4    
+    9981    OUT         send constellation I/Q frames for receiver 1, on request
+    9982    OUT         send constellation I/Q frames for receiver 2, on request
+    9983    OUT         send constellation I/Q frames for receiver 3, on request
+    9984    OUT         send constellation I/Q frames for receiver 4, on request
 */ 
 
+#define CONSTHEADER			8						// constellation frame: 'W' 'H' 'C' rx, sequence (16 bits), pairs (16 bits)
+#define CONSTPAIRS			64						// I/Q pairs read in each constellation bus slot and sent in each frame
+#define CONSTTIMEOUT		5000					// constellation capture stops this long after the last request (ms)
+
 #define EIT_PID				18
 #define ESC					27
+#define EVENT_TIMER			(MAXRECEIVERS+1)		// main loop events: 0-4 are the command sockets, then the check timer
+#define EVENT_WAKE			(MAXRECEIVERS+2)		// . . and the wake up from the signal handler
+#define EVENTS				(MAXRECEIVERS+3)
 #define EVENTID				0						// for EIT
+#define HOUSEKEEPPERIOD		1000					// longest time between the main loop's timeout and idle checks (ms)
+#define HOUSEKEEPMIN		10						// shortest time between them (ms)
+#define I2CTUNE				0						// I2C request classes, highest priority first: tuning
+#define I2CINFO				1						// telemetry polling
+#define I2CCLASSES			2
+#define I2CQUEUESIZE		16						// requests in each I2C queue; must be a power of 2
+#define I2CWAITSLICE		20						// longest wait against the realtime clock without sem_clockwait (ms)
+#define I2CREQ_TUNE			0						// I2C requests: tune a receiver and start a search
+#define I2CREQ_STOP			1						// turn off a receiver's tuner
+#define I2CREQ_INFO			2						// voltage and tone outputs, then read the telemetry
 #define INFOPERIOD      	500 	               	// time in ms between info outputs 
+#define LOCKWATCHPERIOD		5						// time between scan state reads just after a tune (ms)
+#define LOCKWATCHTIME		2000					// . . for this long, or until lock (ms)
 #define MAXFREQ				2600000
-#define MAXFREQSTOSCAN		16
+#define MAXFREQSTOSCAN		64						// frequencies in a scan list
 #define MAXINFOS			100
 #define MAXINICOMMANDS		16						// maximum number of commands in the ini file
 #define MAXINPACKETS      	256						// packets in each input ring buffers
 #define MAXOUTPACKETS      	256						// packets in the  output ring buffer
 #define MAXPIDS				8						// numbers of allowed pids for a program
 #define MAXSRSTOSCAN		16						// number of SRs to scan
+#define MAXSUBSCRIBERS		4						// extra destinations for each receiver's TS
+#define MAXSURVEYRESULTS	64						// signals recorded by a band survey
+#define MAXUDPPACKETS		7						// TS packets in the largest UDP datagram (1316 bytes)
+#define MAXTSOUTDGRAMS		32						// UDP datagrams queued for each receiver between sends
 #define MAXRECEIVERS       	4
 #define MINFREQ				144000
+#define MINPOLLPERIOD		10						// shortest time between telemetry reads (ms)
 #define MAXSR				45000
 #define MINSR				25
 #define NETWORK				0						// not needed by VLC for EIT
 #define NULL_PID			8191
 #define NULL2_PID			8190					// fake null packet insert by some modulators
+#define SURVEYCHECKPERIOD	100						// time between the main loop's checks for the end of a band survey (ms)
+#define SURVEYNAMETIME		1500					// time allowed after a survey lock for the service name to arrive (ms)
 #define	ON					1
 #define OFF					0
+#define VLCQUEUESIZE		16						// key presses waiting for the VLC control thread
+#define VLCTITLESIZE		1024					// longest VLC title bar
+#define VLCTITLEREFRESH		5000					// an unchanged title bar is sent again after this time, in case VLC has replaced it (ms)
+#define TELEM_STATE			0						// telemetry fields polled by the I2C thread: scan state
+#define TELEM_FREQ			1						// carrier offset
+#define TELEM_SR			2						// symbol rate
+#define TELEM_MER			3						// MER
+#define TELEM_MODCOD		4						// modcod, frame type and pilots; puncture rate for DVB-S
+#define TELEM_ROLLOFF		5						// rolloff
+#define TELEMFIELDS			6
+#define NUMPIDS				8192
 #define PAT_PID				0
+#define PID_SEND			0x01					// PID actions: send to the TS output
+#define PID_NULL			0x02					// count as a null packet
+#define PID_PAT				0x04					// parse as PAT
+#define PID_PMT				0x08					// parse as PMT
+#define PID_SDT				0x10					// parse as SDT
 #define PORTINFOLMEX		1						// textual status for all receivers
 #define PORTINFOMULTIRX		2						// 4 line receiver summary
 #define PORTINFOLMEX2		3						// copy of 1
 #define PORTINFOMULTIRX2	4						// copy of 2
 #define PORTINFOLMBASE		60						// LongMynd textual status for receivers
+#define PORTCONSTBASE		80						// output constellation frames to this + RX number
 #define PORTLISTENBASE		20						// listen for receive commands on this + RX number (1-4)
 #define PORTTSBASE			40						// output TS to this + RX number
+#define PSI_PAT				0						// PSI tables remembered for each receiver
+#define PSI_PMT				1
+#define PSI_SDT				2
+#define PSITABLES			3
+#define PSIMAXSECTION		1024					// largest PSI section, including the header and CRC
 #define QO100NO				0
 #define QO100BAND			1
 #define QO100BEACON			2
@@ -120,6 +179,7 @@
 #define SERVICE_AAC			0x0f
 #define SERVICE_AC3			0x77	// ???
 #define TSID				0						// not needed by VLC for EIT
+#define TSREADPACKETS		32						// maximum packets fetched by each driver read
 #define DAY0 				0xc957 					// 31 December 1999 in Julian days
 #define WHHEADER			2						// WinterHill command header seen
 
@@ -134,6 +194,183 @@
 #define IP_MULTI			3
 	
 
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@  the last PSI section parsed for a table, so that repeats of it can be skipped
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+struct psicache
+{
+	uint32				valid ;							// a section has been stored
+	uint32				length ;						// length of the section including the CRC
+	uint8				tableid ;						// table_id
+	uint8				version ;						// version_number, in place
+	uint32				hash ;							// the CRC at the end of the section
+	uint8				section [PSIMAXSECTION] ;		// the section, starting at the table_id
+} ;
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@  a PSI section being assembled from the packets of one pid
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+struct psiassembler
+{
+	uint32				pid ;
+	uint32				cc ;							// continuity counter of the last packet
+	uint32				ccvalid ;
+	uint32				length ;						// bytes assembled; 0 = no section in progress
+	uint32				needed ;						// length of the section including the CRC
+	uint8				section [PSIMAXSECTION] ;		// the section, starting at the table_id
+} ;
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@  a request to the I2C thread
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+struct i2crequest
+{
+	uint32				type ;							// I2CREQ_xxx
+	uint32				rx ;							// TUNE, STOP: receiver
+	uint32				freq ;							// TUNE: frequency passed to the tuner
+	uint32				antenna ;						// TUNE, STOP: 1/2 = TOP/BOT
+	uint32				symbolrate ;					// TUNE: kS
+	uint32				calibrated ;					// TUNE: restrict the frequency scan
+	uint32				scanstep ;						// TUNE: the next step of a scan, not a new command
+	uint8				voltages ;						// INFO: voltage generator control for PIC_A
+	uint8				tonex ;							// INFO: DISTXCFG values for the 22kHz tones
+	uint8				toney ;
+	uint64_t			submittime ;					// time when the request was queued (us)
+	uint64_t			receivetime ;					// TUNE: time when the command arrived (us); 0 if not from a command
+	uint32				sequence ;						// TUNE, STOP: the receiver's tunesequence when it was queued
+} ;
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@  a queue of I2C requests with one producer and the I2C thread as the consumer
+//@  only the producer changes 'in' and only the I2C thread changes 'out', so no lock is needed
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+struct i2cqueue
+{
+	volatile uint32		in ;							// requests queued, free running
+	volatile uint32		out ;							// requests completed, free running
+	struct i2crequest	requests [I2CQUEUESIZE] ;
+} ;
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@  demodulator values read by the I2C thread for the info output
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+struct telemetry
+{
+	uint32				stateread ;						// the state has been read since the receiver was tuned
+	uint8				state ;							// HEADER_MODE from the demodulator
+	bool				locked ;						// the last state read was a header or a lock
+	uint32				nextpoll [TELEMFIELDS] ;		// time at which each field is next read (ms)
+	int32				carfreq ;						// carrier offset (Hz)
+	uint32				symbolrate ;
+	int32				mer ;							// 0.1dB units
+	uint32				modcod ;						// DVB-S2 values
+	bool				shortframe ;
+	bool				pilots ;
+	uint32				rolloff ;
+	uint8				puncture ;						// DVB-S value
+} ;
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@  the settings for one receiver in a command; a batch command holds several
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+struct command
+{
+	int32				header ;						// WHHEADER, QTHEADER, 0 if it is bad, -1 if there is none
+	int32				rx ;							// RCV=, -1 if not given
+	int32				freq ;							// FREQ= (first entry)
+	int32				loc ;							// OFFSET=
+	int32				symbolrate ;					// SRATE= (first entry)
+	int32				antenna ;						// FPLUG=: 1/2 = A/B, -1 if not valid
+	int32				volt ;							// VGX=, VGY=, VOLTAGE=: 1 valid, 0 error, -1 not given
+	int32				prog ;							// PRG=
+	int32				pidpass ;						// PIDPASS=: number of PIDs, -1 if not given
+	int32				pidblock ;						// PIDBLOCK=
+	int32				constellation ;					// CONSTELLATION=: 1 on, 0 off, -1 not given
+	int32				freqcount ;						// entries in freqlist
+	int32				srcount ;						// entries in srlist
+	int32				survey ;						// a band survey
+	int32				tsadd ;							// TSADD=ip:port: 1 valid, 0 error, -1 not given
+	int32				tsremove ;						// TSREMOVE=ip:port or ALL: 1 valid, 2 all, 0 error, -1 not given
+	struct sockaddr_in	tsaddaddr ;
+	struct sockaddr_in	tsremoveaddr ;
+	uint32				freqlist 		[MAXFREQSTOSCAN] ;
+	uint32				srlist 			[MAXSRSTOSCAN] ;
+	uint32				pidpasslist 	[NUMPIDS / 32] ;
+	uint32				pidblocklist 	[NUMPIDS / 32] ;
+} ;
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@  a key press for a VLC window, queued for the VLC control thread
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+struct vlckey
+{
+	uint32				rx ;							// receiver whose VLC window gets the key press
+	char				key ;							// 's' stop, 'n' next
+	uint32				focus ;							// the window is focused first
+} ;
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@  a signal found by a band survey
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+struct surveyresult
+{
+	uint32				rx ;							// the receiver which found it
+	uint32				freq ;							// kHz, including the demodulator offset
+	uint32				symbolrate ;					// kS, as measured
+	int32				mer ;							// 0.1dB units
+	char				name [32] ;						// service name, if it arrived in time
+} ;
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@  an extra destination for a receiver's TS, added by a TSADD= command
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+struct subscriber
+{
+	uint32				active ;						// set last when added, cleared first when removed
+	uint32				generation ;					// odd while addr is being written, bumped on every add
+	struct sockaddr_in	addr ;							// IP address and port
+	uint32				refreshtime ;					// time of the last TSADD= for it (ms)
+	uint32				countgeneration ;				// generation the counts are for; the TS thread
+	uint32				datagrams ;						// . . resets them when it sees a new one
+	uint32				drops ;							// datagrams dropped because the socket buffers were full
+} ;
+
+
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@
 //@  control structure for each of the total of 4 possible receivers on the total of 2 possible NIMs
@@ -160,11 +397,19 @@ struct rxcontrol
 	int32				demodfreq ;						// frequency offset detected by the demodulator
     uint32              enablefreqscan ;        		// scan the 'frequencies' list
     uint32      		frequencies [MAXFREQSTOSCAN] ;	// kHz; multiple frequencies may be scanned
+	uint32				freqcount ;						// number of entries in 'frequencies'
 	uint16              freqindex ;             		// the index of the current frequency in 'frequencies'
 	uint8				eitcontinuity ;					// sequence number for injected EIT packets
 	uint8				eitversion ;					// incrementing version number for injected EIT packets
 	char				eitlist 		[64] ;  		// list of info item numbers to put into a pid 18 EIT packet; 0 = end of list
     uint32              enablesrscan ;          		// scan the 'symbolrates' list           
+	uint32				srcount ;						// number of entries in 'symbolrates'
+	uint32				scansteps ;						// steps taken by the current scan
+	uint32				scanstarttime ;					// time when the current scan was requested (ms)
+	uint32				scantime ;						// time from that request to lock (ms)
+volatile uint32			surveying ;						// the scan lists are this receiver's part of a band survey
+volatile uint32			surveydone ;					// . . and the part has been completed
+	uint32				surveytime ;					// time from the start of the survey to completion (ms)
 	uint32				errors_outsequence ;
 	uint32				errors_insequence ;
 	uint32				errors_restart ;
@@ -207,10 +452,62 @@ struct rxcontrol
 	uint32				requestedprog ;					// the program number in the incoming command
     uint32      		symbolrates [MAXSRSTOSCAN] ;	// kS;  multiple symbol rates may be scanned
 	uint16              srindex ;               		// the index of the current symbol rate in 'symbolrates'
+	struct telemetry	telemetry ;						// demodulator values for the next info output
+	uint32				tunedvalid ;					// the tuner and demodulator are set up as below
+	uint32				tunedfreq ;						// . . frequency passed to the tuner
+	uint32				tunedsr ;						// . . symbol rate
+	uint32				tunedcalibrated ;				// . . frequency scan restricted
+	uint32				tunedantenna ;					// . . antenna
+	uint32				tunerequesttime ;				// time when the last tune was requested (ms)
+	uint32				tuneprogrammed ;				// time from that request to the tuner and demodulator being set up (ms)
+	uint32				tunetolock ;					// time from that request to lock (ms)
+	uint32				commandtotune ;					// time from the last tune command arriving to the tuner and demodulator being set up (us)
+	uint32				tunetopacket ;					// time from that request to the first TS packet being forwarded (ms)
+	uint32				tunereported ;					// the timeline of the last tune has been printed
+	uint32				lockpending ;					// the last tune has not yet locked
+volatile uint32			packetpending ;					// the first TS packet after lock has not yet been forwarded
+volatile uint32			tsgate ;						// the demodulator is locked: TS packets are forwarded
+	uint32				fastretunes ;					// retunes which did not need a full set up
+volatile uint32			tunesequence ;					// number of the last tune or stop request queued
+	uint32				tunesuperseded ;				// tune and stop requests replaced by a newer one before being performed
+	struct i2crequest	tunedeferred ;					// a tune request held back by the minimum retune interval
+	uint32				tunedeferredvalid ;				// . . is waiting
+	uint32				tunecommandtime ;				// time when the last tune request was performed (ms)
 	uint32				timeoutholdoffcount ;			// info is sent a number of times after timing out
+    uint16      		constport ;			    		// port    for constellation output
+	int					constsock ;
+	struct sockaddr_in 	constsockaddr ;
+volatile uint32			constcapture ;					// constellation capture has been requested
+volatile uint32			constrequesttime ;				// time of the last request (ms)
+	uint32				constsequence ;					// frames sent
+	uint8				constlast [2] ;					// the last I/Q pair read
     uint16      		tsport ;			    		// port    for transport stream output
 	int					tssock ;		    			// socket  for transport stream output
 	struct sockaddr_in 	tssockaddr ;	    			//
+	uint8				tsoutbuff [MAXTSOUTDGRAMS][MAXUDPPACKETS * 188] ;	// UDP datagrams waiting to be sent
+	uint32				tsoutlength [MAXTSOUTDGRAMS] ;	// length of each queued datagram
+	uint32				tsoutdgrams ;					// number of queued datagrams; the next is being built
+	uint32				tsoutcount ;					// number of packets in the datagram being built
+	uint32				tsouttime ;						// time when the first packet was put into that datagram (ms)
+	uint32				tssyscalls ;					// sendmmsg calls for the TS output
+	uint32				tsdatagrams ;					// datagrams sent by those calls to the receiver's own destination
+	uint32				tsdrops ;						// datagrams for that destination which could not be sent
+	struct subscriber	subscribers [MAXSUBSCRIBERS] ;	// extra destinations, sent the same datagrams
+	uint32				tslastsyscalls ;				// values at the last info output
+	uint32				tslastdatagrams ;
+	struct psicache		psicache [PSITABLES] ;			// the last PAT, PMT and SDT sections parsed
+	struct psiassembler	psiassembler [PSITABLES] ;		// the PAT, PMT and SDT sections being assembled
+	uint32				psihits ;						// PSI sections skipped because they were unchanged
+	uint32				psimisses ;						// PSI sections that had to be checked and parsed
+volatile uint32			psiclears ;						// incremented atomically by any thread when the PSI sections must be forgotten
+volatile uint32			psiclearsdone ;					// value of psiclears when the TS thread last forgot them
+volatile uint32			psiclearname ;					// the service name is cleared with them
+	uint8				pidactions [NUMPIDS] ;			// PID_xxx for each PID
+volatile uint32			pidtablechanges ;				// incremented atomically by any thread when the PID actions must be rebuilt
+	uint32				pidtablebuilt ;					// value of pidtablechanges when they were built
+	uint32				pidpass  [NUMPIDS / 32] ;		// user PID whitelist bitmap; empty = pass all
+	uint32				pidblock [NUMPIDS / 32] ;		// user PID blacklist bitmap
+	uint32				pidpasscount ;					// number of PIDs in the whitelist
 	uint32				outsequence ;					// 4 bit counter inserted by each PIC 
 	uint32				packetcountprogram ;			// total since the program started
 	uint32				packetcountrx ;					// total for this reception
@@ -391,6 +688,10 @@ volatile	uint32				lastin ;
             char                commandrxbuff  			[256] ;
             char                commandrxbuff2 			[256] ;
             char                commandrxbuff3 			[256] ;
+			struct command		commands 				[MAXRECEIVERS] ;		// the receivers in the last command
+			uint32				commandtunes ;			// tune commands, for the command to tune times below
+			uint64_t			commandtunetime ;		// total time from command arrival to the tuner being set up (us)
+			uint32				commandtunemax ;		// longest of those times (us)
 const 		uint32 				daysinmonth 			[]   = {0,31,28,31,30,31,30,31,31,30,31,30,31} ;
 			char				expandedtextinfo 		[65536] ;
             char				EITDEFAULTS				[64] = {13,12,6,9,12,18,0} ;
@@ -399,10 +700,18 @@ const 		uint32 				daysinmonth 			[]   = {0,31,28,31,30,31,30,31,31,30,31,30,31}
 			uint32				eitremove ;				// EIT packets are removed from the incoming TS
             uint32				GLOBALNIM ; 
 volatile	int32				lminfoutenabled ;		// enable info sending
-volatile	uint32				i2csharedaccess ;		// controls i2c access
+			struct i2cqueue		i2cqueues 		[I2CCLASSES] ;	// requests to the I2C thread, by class
+			sem_t				i2csem ;				// posted when a request is queued
+volatile	int32				i2cserviceenabled ;		// the I2C thread owns the bus
+			pthread_t			i2c_thread ;			// performs all I2C accesses after startup
+			uint32				i2cwaits 		[I2CCLASSES] ;	// number of requests, by class
+			uint64_t			i2cwaittime 	[I2CCLASSES] ;	// total queueing delay, by class (us)
+			uint32				i2cwaitmax 		[I2CCLASSES] ;	// longest queueing delay, by class (us)
 			pthread_t			info_thread ;
 		    uint32      		lastinfotime ;			// time of last info transmission (ms)
 			char				logfilename [64] ;		// name of the log file
+			uint32				mainwakeups ;			// number of times the main loop has run
+			int					mainwakefd ;			// eventfd to wake the main loop when a signal is received
 			uint32				h265max ;				// maximum number of VLC windows to use the hardware decoder
 			uint32				idletime ;				// receiver is disabled after this many seconds of inactivity
 			uint32				inicommandcount ;		// number of commands in the ini file
@@ -414,13 +723,41 @@ volatile	int32				inicommandenabled ;		// enable ini command sending
 			uint32				nullremove ;			// NULL packets are not sent to VLC
 			uint32				offnettime ;			// off net transmission is stopped after this many seconds
 														// of no commands when sending off net
+			uint32				pollperiod 		[TELEMFIELDS] ;	// time between reads of each telemetry field when locked (ms)
+			uint32				pollsearch ;			// time between reads of the scan state while searching (ms)
             uint32              peripherals_virtual_address ;	// virtual address of the peripherals
 			uint32				rxbase ;				// the 4 receivers are numbered starting at this value
+			uint32				scandwell ;				// time spent on each step of a scan without finding a signal (ms)
+			uint32				minretune ;				// shortest time between tune requests being performed for a receiver (ms)
+			struct surveyresult	surveyresults 	[MAXSURVEYRESULTS] ;	// signals found by the band survey
+volatile	uint32				surveyresultcount ;		// . . written only by the I2C thread
+			uint32				surveyrunning ;			// a band survey is running
+			uint32				surveystarttime ;		// time when it was started (ms)
+			uint32				surveysteps ;			// frequency / symbol rate combinations it covers
+			uint32				subscribertime ;		// a TS subscriber is removed after this many seconds without a TSADD=
+volatile	uint32				telemetrylock ;			// the I2C thread has seen a receiver lock
+			uint32				telemetryreads 	[TELEMFIELDS] ;	// number of reads of each telemetry field
 volatile	uint32				terminate ;
 			pthread_t			tsproc_thread ;
+			pthread_t			vlc_thread ;			// sends the key presses and title bars to the VLC windows
+			pthread_cond_t		vlccond ;				// signalled when there is something for it to send
+			pthread_mutex_t		vlcmutex ;				// protects the items below
+			struct vlckey		vlckeys 		[VLCQUEUESIZE] ;	// key presses, in order
+			uint32				vlckeycount ;
+			uint32				vlckeydrops ;			// key presses dropped because the queue was full
+			char				vlctitles 		[MAXRECEIVERS+1][VLCTITLESIZE] ;	// latest title bar for each window
+			uint32				vlctitlepending [MAXRECEIVERS+1] ;	// . . changed since it was last sent
+			uint32				vlctitletime 	[MAXRECEIVERS+1] ;	// . . when it was last queued (ms)
+			uint32				vlctitlecoalesced ;		// title bar changes replaced before they were sent
+			uint32				vlccommands ;			// command lines written to the helper shell
+volatile	int32				vlcenabled ;			// the VLC control thread is running
 volatile    uint32             	txpbindexin ;           // indexes for the UDP sending ring buffer       
 volatile    uint32            	txpbindexout ;                                    
 volatile	int32				tsprocenabled ;			// enable UDP packet sending
+			uint32				tsudppackets ;			// TS packets sent in each UDP datagram
+			uint32				tsflushtime ;			// TS packets are not held for longer than this (ms)
+volatile	uint32				tsreadcount ;			// number of successful driver reads
+volatile	uint32				tsreadpackets ;			// number of packets returned by those reads
 			uint32				qo100beaconfreq ;		// nominal frequency of the beacon
 			uint32				vgxtone ;				// voltage generator X tone
 			uint32				vgxen ;					// voltage generator X enable				--> bit0
@@ -429,20 +766,22 @@ volatile	int32				tsprocenabled ;			// enable UDP packet sending
 			uint32				vgyen ;					// voltage generator Y enable				--> bit4
 			uint32				vgysel ;				// voltage generator Y low / high select	--> bit6
 			int					whfd ;
+			struct whring_control*	whctl ;			// control page of the driver's packet rings, if mapped
+			uint8*				whrings ;				// the driver's packet rings, mapped read only
 			char				nullpacket [188] ;			
 			struct rxcontrol	rcv       				[MAXRECEIVERS+1] ;      // receivers 1-4; 0 is used by the system
 			
 /*
-	i2csharedaccess		
-
-	0: main loop has sole access, 	only main loop may change (to 2)
-	1: main loop wants access,		only info loop may change (to 0)
-	2: info loop has sole access,	only main loop may change (to 1) 
+	After startup, all I2C accesses are made by the I2C thread (i2c_loop).
+	The main loop queues tune and stop requests with i2c_submit and carries on.
+	The info loop queues one request each period which sets the voltage and tone outputs.
+	Between requests, the I2C thread reads the telemetry for each receiver field by field,
+	each at its own rate (i2c_telemetry_poll): only the scan state while searching, everything
+	while locked, and nothing for idle or timed out receivers.
+	Tune requests are served first, including between the receivers of a telemetry poll.
+	Only the latest tune or stop request for a receiver is performed, and tunes are held back
+	so that a receiver is not set up more often than every minretune ms (i2c_tune_latest).
 */
-
-#define I2CMAINHAS		0
-#define I2CMAINWANTS	1
-#define I2CINFOHAS		2
  
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
@@ -452,28 +791,86 @@ volatile	int32				tsprocenabled ;			// enable UDP packet sending
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 
-			uint32			calculateCRC32				(uint8*, uint32) ;
-            int32 			configsockets 				(uint32, uint32) ;
+			void			command_clear				(struct command*) ;
+			uint32			command_parse				(char*, uint32, struct command*) ;
+			int32			command_vg					(char*, uint32*, uint32*, uint32*) ;
+			uint32			command_word				(char*, char*) ;
+            int32 			configsockets 				(uint32, uint32, uint32) ;
+			uint32			housekeeping_wait			(void) ;
 			void*			info_loop					(void*) ;
 			void			getdatetime					(char*) ;
 			int32			getiptype					(char*) ;
 			void* 			inicommand_loop 			(void*) ;
 			void			juliandate					(int32*, int32*) ;
 			void			logit						(char*) ;
+			void			i2c_info_pass				(struct i2crequest*) ;
+			void*			i2c_loop					(void*) ;
+			void			i2c_wait					(uint32) ;
+			uint32			i2c_run_deferred			(void) ;
+			void			i2c_run_queue				(uint32) ;
+			uint32			i2c_telemetry_poll			(void) ;
+			uint32			i2c_constellation			(void) ;
+			void			i2c_scan_step				(uint32) ;
+			void			i2c_survey_record			(uint32) ;
+			void			i2c_stop					(struct i2crequest*) ;
+			void			i2c_tune					(struct i2crequest*) ;
+			void			i2c_tune_latest				(struct i2crequest*) ;
+			uint32			i2c_submit					(uint32, struct i2crequest*) ;
+			uint32			i2c_submit_batch			(uint32, struct i2crequest*, uint32) ;
+			void			i2cqueue_print_stats		(void) ;
             uint32			monotime_ms					(void) ;
+            uint64_t		monotime_us					(void) ;
             int32 			opensocket 					(uint32, char*, uint16*, uint32, int*, struct sockaddr_in*) ;
-			uint32			reverse						(uint32) ;
+			int32			pid_list_parse				(char*, uint32*) ;
+			void			pid_table_build				(uint32) ;
+			uint32			psi_append					(uint32, uint32, uint8*, uint32) ;
+			void			psi_cache_clear				(uint32) ;
+			void			psi_cache_reset				(uint32) ;
+			uint32			psi_cache_hit				(uint32, uint32, uint8*, uint32) ;
+			void			psi_cache_store				(uint32, uint32, uint8*, uint32) ;
+			void			psi_packet					(uint32, uint32, uint8*) ;
+			void			psi_pat						(uint32, uint8*, uint32) ;
+			void			psi_pmt						(uint32, uint8*, uint32) ;
+			uint32			psi_sdt						(uint32, uint8*, uint32) ;
+			void			psi_section					(uint32, uint32, uint8*, uint32) ;
+			int32			scan_list_parse				(char*, uint32*, uint32) ;
+			uint32			subscriber_add				(uint32, struct sockaddr_in*) ;
+			void			subscriber_expire			(void) ;
+			int32			subscriber_parse			(char*, struct sockaddr_in*) ;
+			uint32			subscriber_remove			(uint32, struct sockaddr_in*, char*) ;
+			void			survey_finish				(void) ;
+			uint32			survey_start				(uint32*, uint32, uint32*, uint32, int32, int32) ;
 			void			setup_eit					(void*, uint32, char*) ;
             int             setup_io_map        		(void) ;
 			void			setup_titlebar				(char*, uint32) ;
 			void*			tsproc_loop					(void*) ;
+			void			tsproc_packet				(packetx_t*) ;
+			uint32			tsproc_rings				(uint32) ;
+			uint32			tsproc_drain				(void) ;
+			uint32			tsout_flush					(void) ;
+			void			tsout_packet				(uint32, uint8*) ;
+			void			tsout_queue					(uint32) ;
+			void			tsout_send					(uint32) ;
+			void			vlc_key						(uint32, char, uint32) ;
+			void*			vlc_loop					(void*) ;
+			void			vlc_title					(uint32, char*) ;
 			void			whexit						(int32) ;
 
 void sig_handler (int signum)
 {
+	uint64_t	one ;
+
 	printf ("\r\nSignal %d\r\n", signum) ;
 	
     terminate = 1 ;
+    if (mainwakefd > 0)
+    {
+		one = 1 ;
+		if (write (mainwakefd, &one, sizeof(one)) < 0)		// wake the main loop
+		{
+			one = 0 ;
+		}
+	}
 }
 
     
@@ -493,6 +890,7 @@ int main (int argc, char *argv[])
 	int					spi6interruptnumber ;
 	int					fd ;
 	FILE				*ip ;
+	struct i2crequest	i2creq ;
 	uint32				x ;
 	uint32				y ;
 	uint32				r ;
@@ -514,6 +912,25 @@ int main (int argc, char *argv[])
     int32		        antx  ;
 	int32		        voltx ;
 	int32				reqprogx ;
+	int32				pidpassx ;
+	int32				pidblockx ;
+	int32				constx ;
+	int32				freqcountx ;
+	int32				srcountx ;
+	int32				surveyx ;
+	int32				tsaddx ;
+	int32				tsremovex ;
+	uint32*				freqlistx ;
+	uint32*				srlistx ;
+	uint32*				pidpasslist ;
+	uint32*				pidblocklist ;
+	uint32				sections ;
+	uint32				section ;
+	uint32				batchcount ;
+	struct i2crequest	batchreqs 	 [MAXRECEIVERS] ;
+	uint32				replyrx ;
+	uint32				replygood ;
+	char				replybad 	 [64] ;
 	uint8				nimOK ;
 	uint8				xlnaOK ;
 	uint8				chipid0910 ;
@@ -521,6 +938,14 @@ int main (int argc, char *argv[])
 	uint8				id6120 ;
 	uint32				nowms ;
 	uint32				tempu ;
+	int					epfd ;
+	int					timerfd ;
+	uint32				commandready [MAXRECEIVERS+1] ;
+	uint64_t			wakeus ;
+	uint64_t			expirations ;
+	struct epoll_event	event ;
+	struct epoll_event	events [EVENTS] ;
+	struct itimerspec	timerspec ;
 
 
 	printf ("\r\n\r\n") ;
@@ -543,11 +968,27 @@ int main (int argc, char *argv[])
     qo100beaconfreq	= 10491500 ;
     offnettime		= 3600 ;						// 1 hour timeout when sending off net
     idletime		= 0 ;							// do not switch off receivers after inactivity
+	tsudppackets	= MAXUDPPACKETS ;				// 7 TS packets in each UDP datagram
+	tsflushtime		= 10 ;							// but don't hold a TS packet for more than 10ms
+	scandwell		= 500 ;							// time on each scan step (ms)
+	minretune		= 100 ;							// a burst of tune commands is performed at most every 100ms
+	subscribertime	= 3600 ;						// TS subscribers last an hour unless added again
+	pollsearch		= 50 ;							// telemetry poll periods (ms)
+	pollperiod [TELEM_STATE]   = 250 ;
+	pollperiod [TELEM_FREQ]    = 500 ;
+	pollperiod [TELEM_SR]      = 2000 ;
+	pollperiod [TELEM_MER]     = 500 ;
+	pollperiod [TELEM_MODCOD]  = 2000 ;
+	pollperiod [TELEM_ROLLOFF] = 5000 ;
+	memset (telemetryreads, 0, sizeof(telemetryreads)) ;
+	telemetrylock	= 0 ;
 	inicommandcount = 0 ;
 	memset (inicommands, 0, sizeof(inicommands)) ;
 
+	mainwakefd = eventfd (0, EFD_NONBLOCK) ;
     signal (SIGINT,  sig_handler);
     signal (SIGTERM, sig_handler);
+    signal (SIGPIPE, SIG_IGN) ;								// the VLC helper shell may exit
 
 	sprintf (logfilename, "/home/pi/winterhill/whlog.txt") ;
     
@@ -671,6 +1112,70 @@ int main (int argc, char *argv[])
 						printf ("CALIB_FREQ  %d\r\n", atoi(pos+1)) ;
 						qo100beaconfreq = atoi (pos+1) ;				// calibration frequency
 					}			
+					else if (strcasecmp(buff, "TS_PACKETS") == 0)
+					{
+						printf ("TS_PACKETS  %d\r\n", atoi(pos+1)) ;
+						tsudppackets = atoi (pos+1) ;					// TS packets in each UDP datagram
+						if (tsudppackets < 1 || tsudppackets > MAXUDPPACKETS)
+						{
+							tsudppackets = MAXUDPPACKETS ;
+						}
+					}			
+					else if (strcasecmp(buff, "TS_FLUSH_TIME") == 0)
+					{
+						printf ("TS_FLUSH_TIME %d\r\n", atoi(pos+1)) ;
+						tsflushtime = atoi (pos+1) ;					// maximum time to hold a TS packet (ms)
+					}			
+					else if (strcasecmp(buff, "POLL_SEARCH") == 0)
+					{
+						printf ("POLL_SEARCH %d\r\n", atoi(pos+1)) ;
+						pollsearch = atoi (pos+1) ;						// scan state read period while searching (ms)
+					}			
+					else if (strcasecmp(buff, "POLL_STATE") == 0)
+					{
+						printf ("POLL_STATE  %d\r\n", atoi(pos+1)) ;
+						pollperiod [TELEM_STATE] = atoi (pos+1) ;		// scan state read period when locked (ms)
+					}			
+					else if (strcasecmp(buff, "POLL_FREQ") == 0)
+					{
+						printf ("POLL_FREQ   %d\r\n", atoi(pos+1)) ;
+						pollperiod [TELEM_FREQ] = atoi (pos+1) ;		// carrier offset read period (ms)
+					}			
+					else if (strcasecmp(buff, "POLL_SR") == 0)
+					{
+						printf ("POLL_SR     %d\r\n", atoi(pos+1)) ;
+						pollperiod [TELEM_SR] = atoi (pos+1) ;			// symbol rate read period (ms)
+					}			
+					else if (strcasecmp(buff, "POLL_MER") == 0)
+					{
+						printf ("POLL_MER    %d\r\n", atoi(pos+1)) ;
+						pollperiod [TELEM_MER] = atoi (pos+1) ;			// MER read period (ms)
+					}			
+					else if (strcasecmp(buff, "POLL_MODCOD") == 0)
+					{
+						printf ("POLL_MODCOD %d\r\n", atoi(pos+1)) ;
+						pollperiod [TELEM_MODCOD] = atoi (pos+1) ;		// modcod read period (ms)
+					}			
+					else if (strcasecmp(buff, "POLL_ROLLOFF") == 0)
+					{
+						printf ("POLL_ROLLOFF %d\r\n", atoi(pos+1)) ;
+						pollperiod [TELEM_ROLLOFF] = atoi (pos+1) ;		// rolloff read period (ms)
+					}			
+					else if (strcasecmp(buff, "SCAN_DWELL") == 0)
+					{
+						printf ("SCAN_DWELL  %d\r\n", atoi(pos+1)) ;
+						scandwell = atoi (pos+1) ;						// time on each scan step (ms)
+					}			
+					else if (strcasecmp(buff, "SUBSCRIBER_TIME") == 0)
+					{
+						printf ("SUBSCRIBER_TIME %d\r\n", atoi(pos+1)) ;
+						subscribertime = atoi (pos+1) ;					// TS subscriber timeout (s)
+					}			
+					else if (strcasecmp(buff, "MIN_RETUNE") == 0)
+					{
+						printf ("MIN_RETUNE  %d\r\n", atoi(pos+1)) ;
+						minretune = atoi (pos+1) ;						// shortest time between tunes of a receiver (ms)
+					}			
 					else if (strcasecmp(buff, "COMMAND") == 0)
 					{
 						printf ("COMMAND     %s\r\n", pos+1) ;
@@ -690,6 +1195,18 @@ int main (int argc, char *argv[])
 	    printf ("============================================================================================\r\n") ;                         
 	}
 
+	if (pollsearch < MINPOLLPERIOD)										// keep the telemetry poll rates sensible
+	{
+		pollsearch = MINPOLLPERIOD ;
+	}
+	for (x = 0 ; x < TELEMFIELDS ; x++)
+	{
+		if (pollperiod [x] < MINPOLLPERIOD)
+		{
+			pollperiod [x] = MINPOLLPERIOD ;
+		}
+	}
+
 // look for the I2C port
 
     fd = open ("/dev/i2c-1", O_RDWR) ;
@@ -804,6 +1321,25 @@ int main (int argc, char *argv[])
     *(uint32*)buff = spi5interruptnumber ;			// do it again for good measure
     write (fd, buff, 4) ;
 
+// map the driver's packet rings so that packets can be processed in place
+
+	whctl   = mmap (0, WHRING_CONTROLSIZE, PROT_READ | PROT_WRITE, MAP_SHARED, whfd, 0) ;
+	whrings = mmap (0, 2 * WHRING_RINGSIZE, PROT_READ, MAP_SHARED, whfd, WHRING_CONTROLSIZE) ;
+	if ((whctl == MAP_FAILED) || (whrings == MAP_FAILED))
+	{
+		if (whctl != MAP_FAILED)
+		{
+			munmap (whctl, WHRING_CONTROLSIZE) ;
+		}
+		if (whrings != MAP_FAILED)
+		{
+			munmap (whrings, 2 * WHRING_RINGSIZE) ;
+		}
+		whctl   = 0 ;
+		whrings = 0 ;
+		printf ("The driver's packet rings cannot be mapped - packets will be read\r\n") ;
+	}
+
   
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
@@ -814,10 +1350,16 @@ int main (int argc, char *argv[])
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
     
     memset ((void*)&rcv,0,sizeof(rcv)) ;                    // clear the receiver control structures
+    crc32_init () ;
 
     tsprocenabled	    = 0 ;
     lminfoutenabled     = 0 ;
-    i2csharedaccess 	= I2CMAINHAS ;						// main loop has sole I2C access
+    i2cserviceenabled	= 0 ;								// main loop has sole I2C access during setup
+    sem_init (&i2csem, 0, 0) ;
+    pthread_mutex_init (&vlcmutex, 0) ;
+    pthread_cond_init (&vlccond, 0) ;
+    vlcenabled			= 1 ;
+    memset (&i2creq, 0, sizeof(i2creq)) ;
 	vgxen			    = 0 ;								// voltage generators
 	vgxsel			    = 0 ;	
 	vgxtone				= 0 ;
@@ -1093,10 +1635,12 @@ int main (int argc, char *argv[])
    			strcpy (rcv[rx].ipaddress, baseipaddress) ;
 		}
 		rcv[rx].iptype = getiptype (rcv[rx].ipaddress) ;
+		rcv[rx].pidtablechanges = 1 ;							// build the PID actions before the first packet
 
         rcv[rx].listenport 		= baseipport + PORTLISTENBASE + rx ;	// listen for commands
         rcv[rx].lminfoport  	= baseipport + PORTINFOLMBASE + rx ;	// send original LM $ info 				
         rcv[rx].tsport 			= baseipport + PORTTSBASE + rx ;		// send TS
+        rcv[rx].constport 		= baseipport + PORTCONSTBASE + rx ;		// send constellation frames
         rcv[rx].summaryport  	= baseipport + PORTINFOMULTIRX ;		// send multi rx summary	
         rcv[rx].summary2port  	= baseipport + PORTINFOMULTIRX2 ;		// send multi rx summary	
         rcv[rx].expinfoport  	= baseipport + PORTINFOLMEX ;			// send expanded LM $ info 				
@@ -1114,7 +1658,7 @@ int main (int argc, char *argv[])
     
 	for (rx = 0 ; rx <= MAXRECEIVERS ; rx++)
 	{
-		status = configsockets (rx, ON) ;
+		status = configsockets (rx, ON, 1) ;
 		if (status) 
 		{
 			sprintf (temps, "Error setting up UDP sockets for receiver %d",rx) ;
@@ -1157,6 +1701,22 @@ int main (int argc, char *argv[])
 		whexit (88) ;
 	}	
 
+	status = pthread_create (&i2c_thread, 0, i2c_loop, 0) ;
+	if (status != 0)
+	{
+		logit ("Cannot create thread for i2c_loop") ;
+		printf ("Cannot create thread for i2c_loop\r\n") ;
+		whexit (89) ;
+	}	
+
+	status = pthread_create (&vlc_thread, 0, vlc_loop, 0) ;
+	if (status != 0)
+	{
+		logit ("Cannot create thread for vlc_loop") ;
+		printf ("Cannot create thread for vlc_loop\r\n") ;
+		whexit (90) ;
+	}	
+
     
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
@@ -1203,7 +1763,7 @@ int main (int argc, char *argv[])
 	
     printf ("============================================================================================\r\n") ;                         
 
-	i2csharedaccess 	= I2CINFOHAS ;						// give info loop sole I2C access
+	i2cserviceenabled	= 1 ;								// all I2C accesses are now made by the I2C thread
 
     printf ("============================================================================================\r\n") ;                         
 	printf ("\r\n\r\n\r\n\r\n\r\n\r\n\r\n") ;
@@ -1212,11 +1772,69 @@ int main (int argc, char *argv[])
 	lminfoutenabled  	= 1 ; 								// enable the 4 line status display
 	inicommandenabled 	= 1 ;								// enable thread to send ini commands
 
+// the main loop waits for a command on any of the listening sockets, for the check timer or for a signal
+
+	epfd 	= epoll_create1 (0) ;
+	timerfd = timerfd_create (CLOCK_MONOTONIC, TFD_NONBLOCK) ;
+	if (epfd < 0 || timerfd < 0 || mainwakefd < 0)
+	{
+		logit ("Cannot create the main loop events") ;
+		printf ("Cannot create the main loop events\r\n") ;
+		whexit (91) ;
+	}
+	for (r = 0 ; r <= MAXRECEIVERS ; r++)
+	{
+		event.events 	= EPOLLIN ;
+		event.data.u32 	= r ;
+		epoll_ctl (epfd, EPOLL_CTL_ADD, rcv[r].listensock, &event) ;
+	}
+	event.events 	= EPOLLIN ;
+	event.data.u32 	= EVENT_TIMER ;
+	epoll_ctl (epfd, EPOLL_CTL_ADD, timerfd, &event) ;
+	event.events 	= EPOLLIN ;
+	event.data.u32 	= EVENT_WAKE ;
+	epoll_ctl (epfd, EPOLL_CTL_ADD, mainwakefd, &event) ;
+	memset (&timerspec, 0, sizeof(timerspec)) ;
+
 // main loop
 
     while (1)
     {
-    	usleep (100 * 1000) ;
+		tempu = housekeeping_wait () ;						// time until the next timeout or idle check
+		timerspec.it_value.tv_sec  = tempu / 1000 ;
+		timerspec.it_value.tv_nsec = (tempu % 1000) * 1000000 ;
+		timerfd_settime (timerfd, 0, &timerspec, 0) ;
+
+		memset (commandready, 0, sizeof(commandready)) ;
+		status = 0 ;
+		if (terminate == 0)
+		{
+			status = epoll_wait (epfd, events, EVENTS, -1) ;
+		}
+		wakeus = monotime_us() ;
+		mainwakeups++ ;
+		for (x = 0 ; (int)x < status ; x++)
+		{
+			y = events[x].data.u32 ;
+			if (y <= MAXRECEIVERS)
+			{
+				commandready [y] = 1 ;						// one datagram is read; any more wake the loop again
+			}
+			else if (y == EVENT_TIMER)
+			{
+				if (read (timerfd, &expirations, sizeof(expirations)) < 0)
+				{
+					expirations = 0 ;
+				}
+			}
+			else
+			{
+				if (read (mainwakefd, &expirations, sizeof(expirations)) < 0)
+				{
+					expirations = 0 ;
+				}
+			}
+		}
 
 // check for CTRL-C and other termination commands
 
@@ -1238,6 +1856,22 @@ int main (int argc, char *argv[])
 				pthread_join (tsproc_thread, 0) ;
 				tsproc_thread = 0 ;
 			}
+			if (i2c_thread)
+			{
+				i2cserviceenabled = -1 ;
+				sem_post (&i2csem) ;
+				pthread_join (i2c_thread, 0) ;
+				i2c_thread = 0 ;
+			}
+			if (vlc_thread)
+			{
+				pthread_mutex_lock (&vlcmutex) ;
+				vlcenabled = -1 ;
+				pthread_cond_signal (&vlccond) ;
+				pthread_mutex_unlock (&vlcmutex) ;
+				pthread_join (vlc_thread, 0) ;
+				vlc_thread = 0 ;
+			}
 			if (whfd >= 0)
 			{
 				close (whfd) ;
@@ -1251,15 +1885,10 @@ int main (int argc, char *argv[])
         
         for (r = 0 ; r <= MAXRECEIVERS ; r++)
         {
-			goodx   		=  0  ;
-			headerx 		= -1 ;
-			rxx   			= -1 ;
-            freqx 			= -1 ;
-            locx  			=  0 ;
-            srx   			= -1 ;
-            antx  			= -1 ;
-            voltx 			= -1 ;
-            reqprogx		= 0 ;
+			if (commandready [r] == 0)
+			{
+				continue ;
+			}
  
             memset (commandrxbuff2,0,sizeof(commandrxbuff)) ;
 			memset ((void*)&sourceaddress, 0, sizeof(sourceaddress)) ;
@@ -1287,498 +1916,433 @@ int main (int argc, char *argv[])
 				commandrxbuff  [y] 	= 0 ;
 				commandrxbuff3 [y] 	= 0 ;
 
-// parse the command
+// parse the command: a batch command holds the settings for several receivers
 
-///                if (r == 0)															// pseudo QuickTune command
+				sections 	 = command_parse (commandrxbuff, r, commands) ;
+				batchcount 	 = 0 ;
+				replyrx 	 = 0 ;
+				replygood 	 = 1 ;
+				replybad [0] = 0 ;
+				for (section = 0 ; section < sections ; section++)
 				{
-					pos = strstr (commandrxbuff, "[TO@WH]") ;
-					if (pos)
+					goodx   	= 0 ;
+					headerx 	= commands[section].header ;
+					rxx   		= commands[section].rx ;
+					freqx 		= commands[section].freq ;
+					locx  		= commands[section].loc ;
+					srx   		= commands[section].symbolrate ;
+					antx  		= commands[section].antenna ;
+					voltx 		= commands[section].volt ;
+					reqprogx	= commands[section].prog ;
+					pidpassx	= commands[section].pidpass ;
+					pidblockx	= commands[section].pidblock ;
+					constx		= commands[section].constellation ;
+					freqcountx	= commands[section].freqcount ;
+					srcountx	= commands[section].srcount ;
+					surveyx		= commands[section].survey ;
+					tsaddx		= commands[section].tsadd ;
+					tsremovex	= commands[section].tsremove ;
+					freqlistx	= commands[section].freqlist ;
+					srlistx		= commands[section].srlist ;
+					pidpasslist	= commands[section].pidpasslist ;
+					pidblocklist = commands[section].pidblocklist ;
+
+					if (r == 0)
 					{
-						headerx = WHHEADER ;
-						pos = strstr (commandrxbuff, "RCV=") ;
-						if (pos)
+						if (rxx > 0 && rxx <= MAXRECEIVERS)
 						{
-							pos += strlen ("RCV=") ;
-							rxx  = atoi (pos) ;
-							if (r)
-							{
-								rxx -= rxbase ;
-							}
-							if (rxx != (int)r && r)
-							{
-								headerx = 0 ;
-							}
+							rx = rxx ;															// pseudo QT command
 						}
-	                   	else
-    	               	{
-							headerx = 0 ;
-            	       	}
-					}
-					else if (strncmp (commandrxbuff, "[GLOBALMSG]", 11) == 0)      		// QuickTune command
-					{	
-						headerx = QTHEADER ;
-					}
-				}
-				
-				pos = strstr (commandrxbuff,"FREQ=") ;
-				if (pos)
-				{
-					pos += strlen ("FREQ=") ;
-					freqx = atoi (pos) ;
-				}
-
-				pos = strstr (commandrxbuff,"OFFSET=") ;
-				if (pos)
-				{
-					pos += strlen ("OFFSET=") ;
-					locx = atoi (pos) ;
-				}
-
-				pos = strstr (commandrxbuff,"SRATE=") ;
-				if (pos)
-				{
-					pos += strlen ("SRATE=") ;
-					srx = atoi (pos) ;
-				}
-
-				pos = strstr (commandrxbuff,"FPLUG=") ;
-				if (pos)
-				{
-					pos += strlen ("FPLUG=") ;
-					antx = *pos ;
-					if (antx == 'A')
-					{
-						antx = 1 ;
-					}
-					else if (antx == 'B')
-					{
-						antx = 2 ;
-					}
-					else
-					{
-						antx = -1 ;
-					}
-				}
-
-				pos = strstr (commandrxbuff,"PRG=") ;
-				if (pos)
-				{
-					pos += strlen ("PRG=") ;
-					reqprogx = atoi (pos) ;
-				}
-
-				pos = strstr (commandrxbuff,"VGX=") ;
-				if (pos)
-				{	
-					pos += strlen ("VGX=") ;
-					memset ((void*)temps, 0, sizeof(temps)) ;
-					sscanf (pos, "%s", temps) ;
-					if (strcmp(temps, "OFF") == 0)
-					{
-						vgxen  	= 0 ;									
-						vgxsel  = 0 ;
-						vgxtone = 0 ;
-						voltx   = 1 ;
-					}
-					else if (strcmp(temps, "LO") == 0)
-					{
-						vgxen   = 1 ;									
-						vgxsel  = 0 ;
-						vgxtone = 0 ;
-						voltx   = 1 ;
-					}
-					else if (strcmp(temps, "HI") == 0)
-					{
-						vgxen   = 1 ;									
-						vgxsel  = 1 ;
-						vgxtone = 0 ;
-						voltx   = 1 ;
-					}
-					else if (strcmp(temps, "LOT") == 0)
-					{
-						vgxen   = 1 ;									
-						vgxsel  = 0 ;
-						vgxtone = 1 ;
-						voltx   = 1 ;
-					}
-					else if (strcmp(temps, "HIT") == 0)
+						else
+						{
+							rx = 0 ;
+							rxx = 0 ;
+						}
+	       		    }                     
+	       		    else
+	       		    {
+	       		    	rx  = r ;
+	       		    	rxx = r ;
+	       		    }
+
+					if (headerx >= 0)
 					{
-						vgxen   = 1 ;									
-						vgxsel  = 1 ;
-						vgxtone = 1 ;
-						voltx   = 1 ;
+						sprintf 
+						(
+							temps, 
+							"Command received on port %d (BASE+%d) for RX%d from %s:%d", 
+							rcv[r].listenport, rcv[r].listenport - baseipport, rx, inet_ntoa(sourceaddress.sin_addr), sourceaddress.sin_port
+						) ;
 					}
 					else
 					{
-						voltx   = 0 ;
-					}					
-				}
-
-				pos = strstr (commandrxbuff,"VGY=") ;
-				if (pos)
-				{	
-					pos += strlen ("VGY=") ;
-					memset ((void*)temps, 0, sizeof(temps)) ;
-					sscanf (pos, "%s", temps) ;
-					if (strcmp(temps, "OFF") == 0)
-					{
-						vgyen  	= 0 ;									
-						vgysel  = 0 ;
-						vgytone = 0 ;
-						voltx   = 1 ;
-					}
-					else if (strcmp(temps, "LO") == 0)
-					{
-						vgyen   = 1 ;									
-						vgysel  = 0 ;
-						vgytone = 0 ;
-						voltx   = 1 ;
-					}
-					else if (strcmp(temps, "HI") == 0)
-					{
-						vgyen   = 1 ;									
-						vgysel  = 1 ;
-						vgytone = 0 ;
-						voltx   = 1 ;
-					}
-					else if (strcmp(temps, "LOT") == 0)
-					{
-						vgyen   = 1 ;									
-						vgysel  = 0 ;
-						vgytone = 1 ;
-						voltx   = 1 ;
+						sprintf 
+						(
+							temps, 
+							"Unrecognised data received on port %d (BASE+%d) from %s:%d", 
+							rcv[r].listenport, rcv[r].listenport - baseipport, 
+							inet_ntoa(sourceaddress.sin_addr), sourceaddress.sin_port
+						) ;
+						if (r)
+						{
+							logit (temps) ;
+							logit (commandrxbuff3) ;
+						} 
 					}
-					else if (strcmp(temps, "HIT") == 0)
+					if (rx && section == 0)
 					{
-						vgyen   = 1 ;									
-						vgysel  = 1 ;
-						vgytone = 1 ;
-						voltx   = 1 ;
+						printf 
+						(
+							"\r\nFrom%d: %s:%d\r\n", 
+							r, inet_ntoa(sourceaddress.sin_addr), sourceaddress.sin_port
+						) ;
+					    printf ("%s\r\n", commandrxbuff2) ;											
 					}
-					else
+				
+	                if (rx > 0 && headerx > 0 && freqx >= 0 && locx >= 0 && srx > 0 && antx >= 0 && voltx != 0)		// voltx=0 = error
 					{
-						voltx   = 0 ;
-					}					
-				}
+						if (freqx < locx)
+						{
+							rcv[rx].highsideloc = 1 ;										// LO is on the high side
+						}
+						else
+						{
+							rcv[rx].highsideloc = 0 ;										// LO is on the low side
+						}
+						if (((abs(freqx - locx) >= MINFREQ) && (abs(freqx - locx) <= MAXFREQ)) || freqx == 0)
+						{
+							if ((srx >= MINSR) && (srx <= MAXSR))
+							{
+		                     	goodx = 1 ;													// good command
 
-				pos = strstr (commandrxbuff,"VOLTAGE=") ;
-				if (pos)
-				{
-					pos += strlen ("VOLTAGE=") ;
-					voltx = atoi (pos) ;
-					if (voltx == 0)
-					{
-						vgxen   = 0 ;									
-						vgxsel  = 0 ;
-						voltx   = 1 ;
-					}
-					else if (voltx == 13)
-					{
-						vgxen   = 1 ;									
-						vgxsel  = 0 ;
-						voltx   = 1 ;
-					}
-					else if (voltx == 18)
-					{
-						vgxen   = 1 ;									
-						vgxsel  = 1 ;
-						voltx   = 1 ;
-					}
-					else 
-					{
-						voltx = 0 ;									// error
-					}                        
-				}
-
-				pos = strstr (commandrxbuff,"22KHZ=") ;
-				if (pos)
-				{
-					pos += strlen ("22KHZ=") ;
-					if (strncmp(pos,"OFF",3) == 0)
-					{
-						vgxtone = 0 ;
-					}
-					else if (strncmp(pos,"ON",2) == 0)
-					{
-						vgxtone = 1 ;
-					}
-				}	
-
-				if (r == 0)
-				{
-					if (rxx > 0 && rxx <= MAXRECEIVERS)
-					{
-						rx = rxx ;															// pseudo QT command
-					}
-					else
-					{
-						rx = 0 ;
-						rxx = 0 ;
-					}
-       		    }                     
-       		    else
-       		    {
-       		    	rx  = r ;
-       		    	rxx = r ;
-       		    }
-
-				if (headerx >= 0)
-				{
-					sprintf 
-					(
-						temps, 
-						"Command received on port %d (BASE+%d) for RX%d from %s:%d", 
-						rcv[r].listenport, rcv[r].listenport - baseipport, rx, inet_ntoa(sourceaddress.sin_addr), sourceaddress.sin_port
-					) ;
-				}
-				else
-				{
-					sprintf 
-					(
-						temps, 
-						"Unrecognised data received on port %d (BASE+%d) from %s:%d", 
-						rcv[r].listenport, rcv[r].listenport - baseipport, 
-						inet_ntoa(sourceaddress.sin_addr), sourceaddress.sin_port
-					) ;
-					if (r)
-					{
-						logit (temps) ;
-						logit (commandrxbuff3) ;
-					} 
-				}
-				if (rx)
-				{
-					printf 
-					(
-						"\r\nFrom%d: %s:%d\r\n", 
-						r, inet_ntoa(sourceaddress.sin_addr), sourceaddress.sin_port
-					) ;
-				    printf ("%s\r\n", commandrxbuff2) ;											
-				}
-				
-                if (rx > 0 && headerx > 0 && freqx >= 0 && locx >= 0 && srx > 0 && antx >= 0 && voltx != 0)		// voltx=0 = error
-				{
-					if (freqx < locx)
-					{
-						rcv[rx].highsideloc = 1 ;										// LO is on the high side
-					}
-					else
-					{
-						rcv[rx].highsideloc = 0 ;										// LO is on the low side
-					}
-					if (((abs(freqx - locx) >= MINFREQ) && (abs(freqx - locx) <= MAXFREQ)) || freqx == 0)
-					{
-						if ((srx >= MINSR) && (srx <= MAXSR))
-						{
-	                     	goodx = 1 ;													// good command
-
-							if (rcv[rx].vlcstopped == 0)
-							{
-								rcv[rx].vlcstopped = 1 ;
-								rcv[rx].vlcstopcount++ ;
-								rcv[rx].rawinfos[STATUS_VLCSTOPS] = rcv[rx].vlcstopcount ;
-								if (rcv[rx].xdotoolid)
+								if (rcv[rx].vlcstopped == 0)
 								{
-									sprintf (temps,	"xdotool windowfocus --sync %d key --window %d s", rcv[rx].xdotoolid, rcv[rx].xdotoolid) ;
-									system (temps) ;										// send STOP to VLC
+									rcv[rx].vlcstopped = 1 ;
+									rcv[rx].vlcstopcount++ ;
+									rcv[rx].rawinfos[STATUS_VLCSTOPS] = rcv[rx].vlcstopcount ;
+									if (rcv[rx].xdotoolid)
+									{
+										vlc_key (rx, 's', 1) ;									// send STOP to VLC
+									}
 								}
-							}
-							if ((rx & 1) && (abs(freqx - qo100beaconfreq) <= 200))	
-							{
-								rcv[rx].qo100mode     = QO100BEACON ;
-								freqx 			      = qo100beaconfreq ;
-								rcv[rx].qo100locerror = 0 ;
-							}
-							else if ((freqx >= 10490000) && (freqx < 10500000))			// QO-100
-							{
-								rcv[rx].qo100mode 	= QO100BAND ;
-							}
-							else
-							{
-								rcv[rx].qo100mode   = QO100NO ;
-							}
-
-							rcv[rx].requestedfreq   = freqx ;                            
-							rcv[rx].requestedloc 	= locx ;
-							if (freqx != 0)
-							{                            
-								rcv[rx].hardwarefreq	= abs (rcv[rx].requestedfreq - rcv[rx].requestedloc) ;
-								if (rcv[rx].qo100mode == QO100BAND)
+								if ((rx & 1) && (abs(freqx - qo100beaconfreq) <= 200))	
 								{
-									rcv[rx].hardwarefreq -= rcv[rx].qo100locerror ;
+									rcv[rx].qo100mode     = QO100BEACON ;
+									freqx 			      = qo100beaconfreq ;
+									rcv[rx].qo100locerror = 0 ;
 								}
-							}
-							else
-							{
-								rcv[rx].hardwarefreq = 0 ;
-							}
-							rcv[rx].frequencies[0]  = freqx ;
-							rcv[rx].freqindex       = 0 ;
-							rcv[rx].enablefreqscan  = 0 ;
-							rcv[rx].symbolrates[0]  = srx ;
-							rcv[rx].srindex         = 0 ;
-							rcv[rx].enablesrscan    = 0 ;
-							rcv[rx].antenna         = antx ;
-							rcv[rx].pmtpid			= 0 ;
-							rcv[rx].scanstate       = 0 ;
-							rcv[rx].requestedprog	= reqprogx ;
-    	            		rcv[rx].forbidden 	    = 0 ;
-							if (rcv[rx].receiver)										// see if receiver exists
-							{
-								rcv[rx].active      = 1 ;
-								memset ((void*)&rcv[rx].rawinfos,0,sizeof(rcv[rx].rawinfos)) ;
-								memset ((void*)&rcv[rx].textinfos,0,sizeof(rcv[rx].textinfos)) ;
-								memcpy ((void*)&rcv[rx].eitlist,EITDEFAULTS,sizeof(EITDEFAULTS)) ;  
-								rcv[rx].modechanges++ ;									// count a mode change
-
-								y = STATUS_ANTENNA ;
-								rcv[rx].rawinfos[y] = antx ;
-			
-								rcv[rx].signalacquiredtime 		= 0 ;
-								rcv[rx].signallosttime 			= 0 ;
-								rcv[rx].packetcountrx  	   		= 0 ;					// clear packet count				
-								rcv[rx].nullpacketcountrx  		= 0 ;					// clear null packet count				
-								rcv[rx].errors_sync 			= 0 ;
-								rcv[rx].errors_insequence		= 0 ;
-								rcv[rx].lastmodulation			= 0 ;
-
-								temp = ((rx - 1) & 2) + 1 ;								// force 1 or 3 
-								rcv[temp].errors_outsequence	= 0 ;
-								rcv[temp].errors_restart		= 0 ;
-								
-								if (i2csharedaccess != I2CMAINHAS)
+								else if ((freqx >= 10490000) && (freqx < 10500000))			// QO-100
+								{
+									rcv[rx].qo100mode 	= QO100BAND ;
+								}
+								else
 								{
-									if (i2csharedaccess == I2CINFOHAS)
+									rcv[rx].qo100mode   = QO100NO ;
+								}
+
+								rcv[rx].requestedfreq   = freqx ;                            
+								rcv[rx].requestedloc 	= locx ;
+								if (freqx != 0)
+								{                            
+									rcv[rx].hardwarefreq	= abs (rcv[rx].requestedfreq - rcv[rx].requestedloc) ;
+									if (rcv[rx].qo100mode == QO100BAND)
 									{
-										i2csharedaccess = I2CMAINWANTS ;
+										rcv[rx].hardwarefreq -= rcv[rx].qo100locerror ;
 									}
-									while (i2csharedaccess != I2CMAINHAS)
-									{
-										usleep (10 * 1000) ;
-									}	
-								}					
-												
-								GLOBALNIM = rcv[rx].nim ;
-								stv6120_init 							// configure receiver
-								(
-									rcv[rx].nimreceiver, rcv[rx].hardwarefreq, 
-									rcv[rx].antenna,	 rcv[rx].symbolrates[0]				
-								) ;
-								
-								if (rcv[rx].qo100locerror && rcv[rx].qo100mode != QO100NO)
-								{
-									temp = 1 ;							// in the QO100 band 
-								}										// and rx has been calibrated
+								}
 								else
 								{
-									temp = 0 ;
+									rcv[rx].hardwarefreq = 0 ;
+								}
+								freqlistx[0] = freqx ;										// keep the valid scan entries
+								y = 1 ;
+								for (x = 1 ; x < (uint32) freqcountx && rcv[rx].qo100mode != QO100BEACON ; x++)
+								{
+									temp = abs ((int32) freqlistx[x] - locx) ;
+									if (temp >= MINFREQ && temp <= MAXFREQ)
+									{
+										freqlistx[y++] = freqlistx[x] ;
+									}
+								}
+								freqcountx = y ;
+								srlistx[0] = srx ;
+								y = 1 ;
+								for (x = 1 ; x < (uint32) srcountx ; x++)
+								{
+									if (srlistx[x] >= MINSR && srlistx[x] <= MAXSR)
+									{
+										srlistx[y++] = srlistx[x] ;
+									}
 								}
+								srcountx = y ;
+
+								memcpy (rcv[rx].frequencies, freqlistx, freqcountx * sizeof(uint32)) ;
+								rcv[rx].freqcount       = freqcountx ;
+								rcv[rx].freqindex       = 0 ;
+								rcv[rx].enablefreqscan  = freqcountx > 1 ;
+								memcpy (rcv[rx].symbolrates, srlistx, srcountx * sizeof(uint32)) ;
+								rcv[rx].srcount         = srcountx ;
+								rcv[rx].srindex         = 0 ;
+								rcv[rx].enablesrscan    = srcountx > 1 ;
+								rcv[rx].antenna         = antx ;
+								rcv[rx].pmtpid			= 0 ;
+								rcv[rx].scanstate       = 0 ;
+								rcv[rx].surveying		= 0 ;						// leave any band survey
+								rcv[rx].requestedprog	= reqprogx ;
+	    	            		rcv[rx].forbidden 	    = 0 ;
+								if (rcv[rx].receiver)										// see if receiver exists
+								{
+									rcv[rx].active      = 1 ;
+									memset ((void*)&rcv[rx].rawinfos,0,sizeof(rcv[rx].rawinfos)) ;
+									memset ((void*)&rcv[rx].textinfos,0,sizeof(rcv[rx].textinfos)) ;
+									psi_cache_clear (rx) ;									// parse the new PSI tables
+									__atomic_fetch_add (&rcv[rx].pidtablechanges, 1, __ATOMIC_RELEASE) ;
+									memcpy ((void*)&rcv[rx].eitlist,EITDEFAULTS,sizeof(EITDEFAULTS)) ;  
+									rcv[rx].modechanges++ ;									// count a mode change
+
+									y = STATUS_ANTENNA ;
+									rcv[rx].rawinfos[y] = antx ;
+			
+									rcv[rx].signalacquiredtime 		= 0 ;
+									rcv[rx].signallosttime 			= 0 ;
+									rcv[rx].packetcountrx  	   		= 0 ;					// clear packet count				
+									rcv[rx].nullpacketcountrx  		= 0 ;					// clear null packet count				
+									rcv[rx].errors_sync 			= 0 ;
+									rcv[rx].errors_insequence		= 0 ;
+									rcv[rx].lastmodulation			= 0 ;
+
+									temp = ((rx - 1) & 2) + 1 ;								// force 1 or 3 
+									rcv[temp].errors_outsequence	= 0 ;
+									rcv[temp].errors_restart		= 0 ;
 								
-								stv0910_setup_receive 					// configure demodulator
-								(
-									rcv[rx].nimreceiver, 
-									rcv[rx].symbolrates[0], 
-									temp								// restrict frequency scan when calibrated
-								) ; 
-
-								stv0910_start_scan (rcv[rx].nimreceiver) ;       						// look for a signal
-
-								y = STATUS_STATE ;
-								rcv[rx].scanstate  	= STATE_SEARCH ;
-								rcv[rx].rawinfos[y] = STATE_SEARCH ;
-								tsprocenabled 		= 1 ; 					// enable the packet processing
-								lminfoutenabled 	= 1 ;
+									if (rcv[rx].qo100locerror && rcv[rx].qo100mode != QO100NO)
+									{
+										temp = 1 ;							// in the QO100 band 
+									}										// and rx has been calibrated
+									else
+									{
+										temp = 0 ;
+									}
+								
+									i2creq.type 	  = I2CREQ_TUNE ;		// configure receiver and demodulator
+									i2creq.rx 		  = rx ;				// . . and look for a signal
+									i2creq.freq 	  = rcv[rx].hardwarefreq ;
+									i2creq.antenna 	  = rcv[rx].antenna ;
+									i2creq.symbolrate = rcv[rx].symbolrates[0] ;
+									i2creq.calibrated = temp ;				// restrict frequency scan when calibrated
+									i2creq.receivetime = wakeus ;			// for the command to tune time
+									batchreqs [batchcount++] = i2creq ;		// submitted together after the last receiver
+
+									y = STATUS_STATE ;
+									rcv[rx].tsgate 		= 0 ;					// until the new signal is locked
+									rcv[rx].scanstate  	= STATE_SEARCH ;
+									rcv[rx].rawinfos[y] = STATE_SEARCH ;
+									tsprocenabled 		= 1 ; 					// enable the packet processing
+									lminfoutenabled 	= 1 ;
 
 
 /*
-        GLOBALNIM = NIM_A ;
-                stv6120_print_settings() ;
-                        printf ("\r\n") ;
-                                GLOBALNIM = NIM_B ;
-                                        stv6120_print_settings() ;
-                                                printf ("\r\n") ;
-                                                        GLOBALNIM = NIM_B ;
-                                                                stvvglna_read_regs (0xce) ;
-                                                                        stvvglna_read_regs (0xc8) ;
-                                                                                printf ("\r\n") ;
-
-       printf ("\r\n\r\n\r\n\r\n\r\n") ;
+	        GLOBALNIM = NIM_A ;
+	                stv6120_print_settings() ;
+	                        printf ("\r\n") ;
+	                                GLOBALNIM = NIM_B ;
+	                                        stv6120_print_settings() ;
+	                                                printf ("\r\n") ;
+	                                                        GLOBALNIM = NIM_B ;
+	                                                                stvvglna_read_regs (0xce) ;
+	                                                                        stvvglna_read_regs (0xc8) ;
+	                                                                                printf ("\r\n") ;
+
+	       printf ("\r\n\r\n\r\n\r\n\r\n") ;
 */                                                                               
 
                                                                                 
 
 								
-								printf ("\r\n\r\n\r\n\r\n\r\n\r\n\r\n") ;
-								i2csharedaccess 	= I2CINFOHAS ;			// give I2C access back to info loop
+									printf ("\r\n\r\n\r\n\r\n\r\n\r\n\r\n") ;
+								}
 							}
 						}
 					}
-				}
 
-				if (rxx > 0)										// don't reply to scan info
-				{
-					if (goodx)  
+// constellation requests may be sent on their own or with a tune command
+
+					if (rx > 0 && headerx > 0 && constx >= 0)
 					{
-   	    	    		sprintf (commandreplybuff,"[from@wh:GOOD] \"%s\"\r\n",commandrxbuff3) ;
-						if (modex == MODE_ANYWHERE)
+						if (constx)
 						{
-							if (inet_addr(rcv[rx].ipaddress) != sourceaddress.sin_addr.s_addr)	// address change
-							{
-								rcv[rx].ipchanges++ ;											// count an IP change
-								strcpy (rcv[rx].newipaddress, inet_ntoa(sourceaddress.sin_addr)) ;	// new address
-							}
+							rcv[rx].constrequesttime = monotime_ms() ;
+						}
+						rcv[rx].constcapture = constx ;						// captured by the I2C thread
+						if (freqx < 0)
+						{
+							goodx = 1 ;										// not a tune command
 						}
-						strcpy (rcv[rx].commandip, inet_ntoa(sourceaddress.sin_addr)) ;			// command address
-						rcv[rx].commandreceivedtime  = monotime_ms() ;		// command arrival time
-						rcv[rx].timedouttime = 0 ;					// reset time of timeout
+					}
 
-// update the command time for other receivers going to the same command IP address
+// a band survey is shared between the idle receivers
+
+					if (surveyx)
+					{
+						temp = 0 ;
+						if (freqcountx > 0 && srcountx > 0 && locx >= 0 && antx > 0)
+						{
+							temp = survey_start (freqlistx, freqcountx, srlistx, srcountx, locx, antx) ;
+						}
+						if (temp)
+						{
+			   	    		sprintf (commandreplybuff,"[from@wh:GOOD] \"%s\" on %d receivers\r\n",commandrxbuff3,temp) ;
+						}
+						else
+						{
+			   	    		sprintf (commandreplybuff,"[from@wh:BAD]  \"%s\"\r\n",commandrxbuff3) ;
+						}
+	   	    		    status = sendto	                           					// reply
+	    	   	       	(
+	   	    	           	rcv[0].listensock, commandreplybuff, strlen(commandreplybuff)+1, 0,
+			    	        (struct sockaddr*) &sourceaddress, sizeof(sourceaddress)
+	      			    ) ;
+					}
+
+// PID filter commands may be sent on their own or with a tune command
 
-						for (x = 1 ; x <= MAXRECEIVERS ; x++)
+					if (rx > 0 && headerx > 0 && (pidpassx >= 0 || pidblockx >= 0))
+					{
+						if (pidpassx >= 0)
 						{
-							if (rcv[x].active && rcv[x].commandreceivedtime)
-							{
-								if (strcmp(rcv[x].commandip, rcv[rx].commandip) == 0)
+							memcpy (rcv[rx].pidpass, pidpasslist, sizeof(rcv[rx].pidpass)) ;
+							rcv[rx].pidpasscount = pidpassx ;
+						}
+						if (pidblockx >= 0)
+						{
+							memcpy (rcv[rx].pidblock, pidblocklist, sizeof(rcv[rx].pidblock)) ;
+						}
+						__atomic_fetch_add (&rcv[rx].pidtablechanges, 1, __ATOMIC_RELEASE) ;		// rebuilt by tsproc_packet
+						if (freqx < 0)
+						{
+							goodx = 1 ;										// not a tune command
+						}
+					}
+
+// TS subscribers may be added or removed on their own or with a tune command
+
+					if (rx > 0 && headerx > 0 && (tsaddx >= 0 || tsremovex >= 0))
+					{
+						temp = tsaddx != 0 && tsremovex != 0 ;					// both valid if given
+						if (tsremovex > 0)
+						{
+							subscriber_remove (rx, tsremovex == 1 ? &commands[section].tsremoveaddr : 0, "removed") ;
+						}
+						if (tsaddx > 0 && subscriber_add (rx, &commands[section].tsaddaddr) == 0)
+						{
+							temp = 0 ;											// no room
+						}
+						if (freqx < 0)
+						{
+							goodx = temp ;										// not a tune command
+						}
+					}
+
+					if (rxx > 0)										// don't reply to scan info
+					{
+						replyrx = rx ;
+						if (goodx)  
+						{
+							if (freqx >= 0)									// PID or TS subscriber changes alone keep
+							{												// . . the receiver's address and timeout
+								if (modex == MODE_ANYWHERE)
 								{
-									rcv[x].commandreceivedtime = rcv[rx].commandreceivedtime ;
+									if (inet_addr(rcv[rx].ipaddress) != sourceaddress.sin_addr.s_addr)	// address change
+									{
+										rcv[rx].ipchanges++ ;											// count an IP change
+										strcpy (rcv[rx].newipaddress, inet_ntoa(sourceaddress.sin_addr)) ;	// new address
+									}
 								}
+								strcpy (rcv[rx].commandip, inet_ntoa(sourceaddress.sin_addr)) ;			// command address
+								rcv[rx].commandreceivedtime  = monotime_ms() ;		// command arrival time
+								rcv[rx].timedouttime = 0 ;					// reset time of timeout
+
+// update the command time for other receivers going to the same command IP address
+
+								for (x = 1 ; x <= MAXRECEIVERS ; x++)
+								{
+									if (rcv[x].active && rcv[x].commandreceivedtime)
+									{
+										if (strcmp(rcv[x].commandip, rcv[rx].commandip) == 0)
+										{
+											rcv[x].commandreceivedtime = rcv[rx].commandreceivedtime ;
+										}
+									}
+								}						
 							}
-						}						
+						}
+						else
+						{
+							replygood = 0 ;
+							sprintf (&replybad [strlen(replybad)], " RCV=%d", rxx) ;	// for the reply to a batch
+							sprintf 
+							(
+								temps, 
+								"Bad data received on port %d (BASE+%d) from %s:%d", 
+								rcv[r].listenport, rcv[r].listenport - baseipport, 
+								inet_ntoa(sourceaddress.sin_addr), sourceaddress.sin_port
+							) ;
+							logit (temps) ;
+							logit (commandrxbuff3) ;
+	       			   	}
+	       		   	}
+				}
+
+// the tune requests are queued together, so the I2C thread sets up all the receivers in one pass
+
+				if (batchcount)
+				{
+					i2c_submit_batch (I2CTUNE, batchreqs, batchcount) ;
+				}
+
+// one reply for the whole command
+
+				if (r == 0 && replyrx)										// only reply to pseudo commands
+				{
+					if (replygood)
+					{
+   	    	    		sprintf (commandreplybuff,"[from@wh:GOOD] \"%s\"\r\n",commandrxbuff3) ;
+					}
+					else if (sections > 1)
+					{
+	       	    		sprintf (commandreplybuff,"[from@wh:BAD]  \"%s\" failed:%s\r\n",commandrxbuff3,replybad) ;
 					}
 					else
 					{
 	       	    		sprintf (commandreplybuff,"[from@wh:BAD]  \"%s\"\r\n",commandrxbuff3) ;
-					}        		
-					if (r == 0 && rxx != 0)										// only reply to pseudo commands
-					{
-	   	    		    status = sendto	                           				// reply
-	    	   	       	(
-    	    	           	rcv[rx].listensock, commandreplybuff, strlen(commandreplybuff)+1, 0,
-			    	        (struct sockaddr*) &sourceaddress, sizeof(sourceaddress)
-       			    	) ;
-       			    }
-					if (goodx == 0)
-					{
-						sprintf 
-						(
-							temps, 
-							"Bad data received on port %d (BASE+%d) from %s:%d", 
-							rcv[r].listenport, rcv[r].listenport - baseipport, 
-							inet_ntoa(sourceaddress.sin_addr), sourceaddress.sin_port
-						) ;
-						logit (temps) ;
-						logit (commandrxbuff3) ;
-       			   	}
-       		   	}
+					}
+   	    		    status = sendto	                           					// reply
+    	   	       	(
+   	    	           	rcv[replyrx].listensock, commandreplybuff, strlen(commandreplybuff)+1, 0,
+		    	        (struct sockaddr*) &sourceaddress, sizeof(sourceaddress)
+      			    ) ;
+				}
 			}
 		}
 
 
+// remove the TS subscribers which have not been added again in time
+
+		subscriber_expire () ;
+
+// finish a band survey when all its receivers have completed their parts
+
+		if (surveyrunning)
+		{
+			survey_finish () ;
+		}
+
 // check for timeout for TS leaving the building
+// a surveying receiver is left alone: its part ends at the end of its list and survey_finish stops it
 
 		for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)
 		{
-			if (rcv[rx].active)
+			if (rcv[rx].active && rcv[rx].surveying == 0)
 			{
 				if (rcv[rx].scanstate != STATE_TIMEOUT && rcv[rx].scanstate != STATE_IDLE)
 				{
@@ -1791,24 +2355,12 @@ int main (int argc, char *argv[])
 							rcv[rx].timeoutholdoffcount = 4 ;		// send info 4 times after timeout
 							rcv[rx].commandreceivedtime = 0 ;
 							rcv[rx].timedouttime = monotime_ms() ;	// time of timeout
-							if (i2csharedaccess != I2CMAINHAS)		// acquire access to I2C
-							{
-								if (i2csharedaccess == I2CINFOHAS)
-								{
-									i2csharedaccess = I2CMAINWANTS ;
-								}
-								while (i2csharedaccess != I2CMAINHAS)
-								{
-									usleep (10 * 1000) ;
-								}	
-							}									
-							GLOBALNIM = rcv[rx].nim ;
-							stv6120_init 							// configure receiver
-							(
-								rcv[rx].nimreceiver, 0,				// turn off the receiver
-								rcv[rx].antenna,	 rcv[rx].symbolrates[0]				
-							) ;												
-							i2csharedaccess = I2CINFOHAS ;			// give I2C access back to info loop
+							rcv[rx].tsgate 	  = 0 ;
+							i2creq.type 	  = I2CREQ_STOP ;			// turn off the receiver
+							i2creq.rx 		  = rx ;
+							i2creq.antenna 	  = rcv[rx].antenna ;
+							i2creq.symbolrate = rcv[rx].symbolrates[0] ;
+							i2c_submit (I2CTUNE, &i2creq) ;
 						}
 					}
 				}
@@ -1821,7 +2373,7 @@ int main (int argc, char *argv[])
       	for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)
 		{
 			temp = 0 ;
-       		if (rcv[rx].active && rcv[rx].scanstate != STATE_IDLE)
+       		if (rcv[rx].active && rcv[rx].scanstate != STATE_IDLE && rcv[rx].surveying == 0)
        		{
        			if (rcv[rx].scanstate == STATE_LOST)
        			{
@@ -1850,24 +2402,12 @@ int main (int argc, char *argv[])
 					rcv[rx].rawinfos[STATUS_STATE] 	= STATE_IDLE ;		
     	   			rcv[rx].signallosttime 			= 0 ;       			
 					rcv[rx].timeoutholdoffcount 	= 4 ;	// send info 4 times after timeout
-					if (i2csharedaccess != I2CMAINHAS)		// acquire access to I2C
-					{
-						if (i2csharedaccess == I2CINFOHAS)
-						{
-							i2csharedaccess = I2CMAINWANTS ;
-						}
-						while (i2csharedaccess != I2CMAINHAS)
-						{
-							usleep (10 * 1000) ;
-						}	
-					}									
-					GLOBALNIM = rcv[rx].nim ;
-					stv6120_init 							// configure receiver
-					(
-						rcv[rx].nimreceiver, 0,				// turn off the receiver
-						rcv[rx].antenna,	 rcv[rx].symbolrates[0]				
-					) ;												
-					i2csharedaccess = I2CINFOHAS ;			// give I2C access back to info loop       		
+					rcv[rx].tsgate 	  = 0 ;
+					i2creq.type 	  = I2CREQ_STOP ;			// turn off the receiver
+					i2creq.rx 		  = rx ;
+					i2creq.antenna 	  = rcv[rx].antenna ;
+					i2creq.symbolrate = rcv[rx].symbolrates[0] ;
+					i2c_submit (I2CTUNE, &i2creq) ;
     	   		}
     	   	}
        	}	               
@@ -1875,6 +2415,88 @@ int main (int argc, char *argv[])
 }
 
 
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 housekeeping_wait
+//@
+//@	 find the time until the main loop must next check for an off net timeout, an idle receiver
+//@	 or a TS subscriber timeout
+//@	 the state of a receiver can be changed by the other threads, so the checks are made
+//@	 at least every HOUSEKEEPPERIOD, and every SURVEYCHECKPERIOD while a band survey is running
+//@
+//@	 Calling:
+//@
+//@	 Return:	time to wait (ms)
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+uint32 housekeeping_wait (void)
+{
+		uint32		rx ;
+		uint32		nowms ;
+		uint32		waitms ;
+		uint32		due [3] ;
+		uint32		dues ;
+		uint32		n ;
+		int32		left ;
+
+	nowms  = monotime_ms() ;
+	waitms = surveyrunning ? SURVEYCHECKPERIOD : HOUSEKEEPPERIOD ;
+	for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)
+	{
+		if (rcv[rx].active == 0 || rcv[rx].scanstate == STATE_IDLE || rcv[rx].surveying)
+		{
+			continue ;
+		}
+		dues = 0 ;
+		if (rcv[rx].scanstate != STATE_TIMEOUT && rcv[rx].iptype == IP_OFFNET)
+		{
+			due [dues++] = rcv[rx].commandreceivedtime + offnettime * 1000 ;	// off net sending stops
+		}
+		if (idletime)
+		{
+			if (rcv[rx].scanstate == STATE_LOST)
+			{
+				due [dues++] = rcv[rx].signallosttime + idletime * 1000 ;		// receiver goes idle
+			}
+			else if (rcv[rx].scanstate == STATE_SEARCH)
+			{
+				due [dues++] = rcv[rx].commandreceivedtime + idletime * 1000 ;
+			}
+			else if (rcv[rx].scanstate == STATE_TIMEOUT)
+			{
+				due [dues++] = rcv[rx].timedouttime + idletime * 1000 ;
+			}
+		}
+		for (n = 0 ; n < dues ; n++)
+		{
+			left = (int32) (due [n] - nowms) ;
+			if (left < (int32) waitms)
+			{
+				waitms = left < HOUSEKEEPMIN ? HOUSEKEEPMIN : left ;
+			}
+		}
+	}
+	for (rx = 1 ; rx <= MAXRECEIVERS && subscribertime ; rx++)
+	{
+		for (n = 0 ; n < MAXSUBSCRIBERS ; n++)
+		{
+			if (rcv[rx].subscribers[n].active)									// TS subscriber times out
+			{
+				left = (int32) (rcv[rx].subscribers[n].refreshtime + subscribertime * 1000 - nowms) ;
+				if (left < (int32) waitms)
+				{
+					waitms = left < HOUSEKEEPMIN ? HOUSEKEEPMIN : left ;
+				}
+			}
+		}
+	}
+	return (waitms) ;
+}
+
+
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@
@@ -1978,13 +2600,17 @@ int getiptype (char *testipaddress)
 //@	 Calling:	receiver number 		1-4
 //@                                     0 is used by the system
 //@				state					0/1 for close/open
+//@				fixed					1 to include the sockets that an IP change leaves open:
+//@										the command socket, which is registered with the main
+//@										loop's epoll, and the constellation socket, which the
+//@										I2C thread sends on at any time
 //@
 //@	 Return:	
 //@
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 
-int32 configsockets (uint32 receiver, uint32 offon)
+int32 configsockets (uint32 receiver, uint32 offon, uint32 fixed)
 {
 	int32		err ;
 	int			rx ;
@@ -1994,15 +2620,18 @@ int32 configsockets (uint32 receiver, uint32 offon)
 
    	if (1)
    	{
-		err |= opensocket 
-		(
-			offon, 
-			rcv[rx].ipaddress,
-			&rcv[rx].listenport,
-			1,												// listening
-			&rcv[rx].listensock,
-			&rcv[rx].listensockaddr
-		) ;
+		if (fixed)
+		{
+			err |= opensocket 
+			(
+				offon, 
+				rcv[rx].ipaddress,
+				&rcv[rx].listenport,
+				1,											// listening
+				&rcv[rx].listensock,
+				&rcv[rx].listensockaddr
+			) ;
+		}
 		err |= opensocket 
 		(
 			offon, 
@@ -2058,6 +2687,19 @@ int32 configsockets (uint32 receiver, uint32 offon)
 			&rcv[rx].tssock,
 			&rcv[rx].tssockaddr 
 		) ;	
+
+		if (fixed)											// opened before the first command in anywhere mode:
+		{													// . . it goes nowhere until info_loop sets the address
+			err |= opensocket 
+			(
+				offon,
+				rcv[rx].ipaddress[0] ? rcv[rx].ipaddress : "0.0.0.0",
+				&rcv[rx].constport,
+				0,											// not listening
+				&rcv[rx].constsock,
+				&rcv[rx].constsockaddr 
+			) ;	
+		}
 	}
 	return (err) ;
 }
@@ -2190,426 +2832,1468 @@ uint32 monotime_ms()
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@
-//@	 a thread to to send commands from the .ini file        
+//@	 monotime_us
 //@
-//@	 Calling:	
+//@	 get the monotonic time in microseconds
 //@
-//@	 Return:	
+//@	 Calling:
+//@
+//@	 Return:	time in microseconds
 //@
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 
-void* inicommand_loop (void* dummy)
-{	
-	uint32		x ;
-	uint32		tempu ;
-	int32		status ;
-	(void)		dummy ;
-	
-	while (inicommandenabled == 0) 
-	{
-		usleep (1000) ;
-	}
 
-	if (inicommandcount)
-	{
-		printf ("Sending ini file commands\r\n") ;
-		for (x = 0 ; x < inicommandcount ; x++)
-		{
-    		if ((strlen(inicommands[x]) == 1) && isdigit(inicommands[x][0]))	// single digit
-    		{
-				tempu = inicommands[x][0] & 0xf ;
-				printf ("Delaying %d seconds\r\n", tempu) ;
-				usleep (tempu * 1000 * 1000) ;				// delay tempu seconds
-    		}
-			else
-			{
-	    		printf ("%s\r\n", inicommands[x]) ;
-    			status = sendto
-    			(
-		    		rcv[0].tssock, inicommands[x], strlen(inicommands[x]) + 1, 0,
-			        (struct sockaddr*) &rcv[0].listensockaddr, sizeof(rcv[0].listensockaddr)
-    			) ;
-    			(void) status ;
-	    		usleep (100 * 1000) ;
-    		}
-    	}
-	}
-	return (0) ;
+uint64_t monotime_us() 
+{  
+    struct timespec 	tp ; 
+    
+    if (clock_gettime(CLOCK_MONOTONIC, &tp) != 0) 
+    {
+        return (0) ;
+    }
+    return ((uint64_t) tp.tv_sec * 1000000 + tp.tv_nsec / 1000) ;
 }
 
 
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@
-//@	 a thread to check if it's time for an info output        
-//@  display the receiver summary and sent info via udp
+//@	 i2c_submit
 //@
-//@	 Calling:	
+//@	 queue a request for the I2C thread
+//@	 each class has one producer: the main loop for I2CTUNE, the info loop for I2CINFO
+//@	 waits if the queue is full
 //@
-//@	 Return:	
+//@	 Calling:	class		I2CTUNE or I2CINFO
+//@				req			the request, which is copied
+//@
+//@	 Return:	the completion count which the request will reach
 //@
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 
-void* info_loop (void* dummy)
+
+uint32 i2c_submit (uint32 class, struct i2crequest* req)
 {
-		int				err ;
-		uint32			rx ;
-		uint32			x ;
-		uint32			y ;
-		char			titlebar [4096] ;
-		char			temps    [5000] ;
-		char			temps2   [4096] ;
-		char			temps3   [64] ;
-		bool			bool1 ;
-		bool			bool2 ;
-		uint8			tempc ;	
-		int32			temp ;
-		uint32			tempu ;
-		char			command       [256] ;
-		char			output   	  [4096] ;
-		char			outputonnet   [4096] ;
-		char			outputoffnet  [4096] ;
-		int32			status ;
-static	uint32			counter ;
-		uint32			thenms ;
-		struct in_addr	sia ;
-	
-  		(void) dummy ;
+	return (i2c_submit_batch (class, req, 1)) ;
+}
 
 
-	while (lminfoutenabled == 0) 
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 i2c_submit_batch
+//@
+//@	 queue several requests for the I2C thread
+//@	 they are published together, so the I2C thread performs them all in one pass
+//@
+//@	 Calling:	class		I2CTUNE or I2CINFO
+//@				reqs		the requests
+//@				count		number of requests, up to I2CQUEUESIZE
+//@
+//@	 Return:	the completion count which the last request will reach
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+uint32 i2c_submit_batch (uint32 class, struct i2crequest* reqs, uint32 count)
+{
+		struct i2cqueue*	q ;
+		uint32				in ;
+		uint32				n ;
+		uint64_t			nowus ;
+
+	q  = &i2cqueues [class] ;
+	in = q->in ;
+	while (in + count - __atomic_load_n (&q->out, __ATOMIC_ACQUIRE) > I2CQUEUESIZE)
 	{
-		usleep (1000) ;
+		usleep (1000) ;												// queue full
 	}
 
-   	thenms = monotime_ms() ;											// current time
-	while (lminfoutenabled == 1)
-    {    
+	nowus = monotime_us() ;
+	for (n = 0 ; n < count ; n++)
+	{
+		reqs[n].submittime = nowus ;
+		if (class == I2CTUNE)
+		{
+			reqs[n].sequence = ++rcv[reqs[n].rx].tunesequence ;				// older requests for the receiver are now superseded
+		}
+		q->requests [(in + n) & (I2CQUEUESIZE - 1)] = reqs[n] ;
+	}
+	__atomic_store_n (&q->in, in + count, __ATOMIC_RELEASE) ;		// publish the requests
+	sem_post (&i2csem) ;
+
+	return (in + count) ;
+}
 
-		while (((monotime_ms() - thenms) < INFOPERIOD) || (i2csharedaccess != I2CINFOHAS))
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 i2c_run_queue
+//@
+//@	 perform the requests waiting in one queue
+//@	 the queueing delay of each request is recorded for its class
+//@
+//@	 Calling:	class		I2CTUNE or I2CINFO
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+
+void i2c_run_queue (uint32 class)
+{
+		struct i2cqueue*	q ;
+		struct i2crequest*	req ;
+		uint32				out ;
+		uint32				waitus ;
+
+	q = &i2cqueues [class] ;
+	while ((out = q->out) != __atomic_load_n (&q->in, __ATOMIC_ACQUIRE))
+	{
+		req    = &q->requests [out & (I2CQUEUESIZE - 1)] ;
+		waitus = monotime_us() - req->submittime ;
+		i2cwaits    [class]++ ;
+		i2cwaittime [class] += waitus ;
+		if (waitus > i2cwaitmax [class])
 		{
-			if (i2csharedaccess == I2CMAINWANTS)
-			{
-				i2csharedaccess = I2CMAINHAS ;
-			}
-       		usleep (10 * 1000) ; 										// sleep 10ms
-       	}
-		thenms += INFOPERIOD ;
+			i2cwaitmax [class] = waitus ;
+		}
 
-		counter++ ;														// for EIT injection
+		switch (req->type)
+		{
+			case I2CREQ_TUNE :
+			case I2CREQ_STOP :
+				i2c_tune_latest (req) ;
+				break ;
+
+			case I2CREQ_INFO :
+				i2c_info_pass (req) ;
+				break ;
+		}
 
-// output voltage commands
+		__atomic_store_n (&q->out, out + 1, __ATOMIC_RELEASE) ;						// request completed
+	}
+}
 
-		tempc = 0 ;
-		if (vgxen)  tempc |= 0x01 ;
-		if (vgxsel) tempc |= 0x04 ;
-		if (vgyen)  tempc |= 0x10 ;
-		if (vgysel) tempc |= 0x40 ;
-		tempc |= 0xaa ;													// turn on the valid bit for each item		
-///		i2c_write_pic16 (PIC_ADDR_A, 0xc5, tempc, tempc ^ 0xff) ; 
-		i2c_write_pic8 (PIC_ADDR_A, 0x94, tempc) ;
-		i2c_write_pic8 (PIC_ADDR_A, 0x95, tempc ^ 0xff) ; 
 
-// output 22kHz commands
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 i2c_tune_latest
+//@
+//@	 perform a tune or stop request from the main loop if it is still the latest for its receiver
+//@	 a request which has been superseded by a newer one is dropped, so a burst of commands
+//@	 only sets up the hardware for the last; a tune within minretune of the previous one
+//@	 is held in the receiver's deferred slot until i2c_run_deferred finds it due
+//@
+//@	 Calling:	req			the request
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 
-		GLOBALNIM = NIM_A ;
-		if (vgxtone == 0)
+void i2c_tune_latest (struct i2crequest* req)
+{
+		struct rxcontrol*	rp ;
+
+	rp = &rcv [req->rx] ;
+	if (req->sequence != rp->tunesequence)										// a newer request is on its way
+	{
+		rp->tunesuperseded++ ;
+		return ;
+	}
+	if (rp->tunedeferredvalid)													// replaced by this one
+	{
+		rp->tunedeferredvalid = 0 ;
+		rp->tunesuperseded++ ;
+	}
+
+	if (req->type == I2CREQ_STOP)
+	{
+		i2c_stop (req) ;
+	}
+	else if (monotime_ms() - rp->tunecommandtime < minretune)
+	{
+		rp->tunedeferred 	  = *req ;
+		rp->tunedeferredvalid = 1 ;
+	}
+	else
+	{
+		i2c_tune (req) ;
+		rp->tunecommandtime = monotime_ms() ;
+	}
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 i2c_run_deferred
+//@
+//@	 perform the held back tune requests which are now due
+//@
+//@	 Calling:
+//@
+//@	 Return:	time until the next one is due (ms), INFOPERIOD if there are none
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+uint32 i2c_run_deferred (void)
+{
+		uint32				rx ;
+		uint32				waitms ;
+		uint32				elapsed ;
+		struct rxcontrol*	rp ;
+
+	waitms = INFOPERIOD ;
+	for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)
+	{
+		rp = &rcv [rx] ;
+		if (rp->tunedeferredvalid == 0)
 		{
-			tempc = KHZ22OFF ;											// defined in stv0910.h	
+			continue ;
 		}
-		else
+		if (rp->tunedeferred.sequence != rp->tunesequence)						// a newer request is on its way
 		{
-			tempc = KHZ22ON ;										
+			rp->tunedeferredvalid = 0 ;
+			rp->tunesuperseded++ ;
+			continue ;
+		}
+		elapsed = monotime_ms() - rp->tunecommandtime ;
+		if (elapsed >= minretune)
+		{
+			rp->tunedeferredvalid = 0 ;
+			i2c_tune (&rp->tunedeferred) ;
+			rp->tunecommandtime = monotime_ms() ;
+		}
+		else if (minretune - elapsed < waitms)
+		{
+			waitms = minretune - elapsed ;
 		}
-		err = stv0910_write_reg (RSTV0910_P1_DISTXCFG, tempc) ;		
+	}
+	return (waitms) ;
+}
 
-		if (vgytone == 0)
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 i2c_stop
+//@
+//@	 turn off a receiver's tuner
+//@
+//@	 Calling:	req			the request
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void i2c_stop (struct i2crequest* req)
+{
+	GLOBALNIM = rcv[req->rx].nim ;
+	stv6120_init (rcv[req->rx].nimreceiver, 0, req->antenna, req->symbolrate) ;
+	rcv[req->rx].tunedvalid  = 0 ;
+	rcv[req->rx].tsgate 	 = 0 ;
+	rcv[req->rx].lockpending = 0 ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 i2c_tune
+//@
+//@	 set up a receiver's tuner and demodulator and start a search
+//@	 if the receiver is already running on the same antenna, only what has changed is set up:
+//@	 the tuner PLL for a new frequency, the lowpass filter for a new cutoff, and the
+//@	 demodulator loops for a new symbol rate
+//@
+//@	 Calling:	req			the I2CREQ_TUNE request
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+
+void i2c_tune (struct i2crequest* req)
+{
+		struct rxcontrol*	rp ;
+		bool				recal ;
+		bool				loops ;
+
+	rp 		  = &rcv[req->rx] ;
+	GLOBALNIM = rp->nim ;
+
+	if (rp->tunedvalid && rp->tunedantenna == req->antenna)
+	{
+		recal = stv6120_filter_cf (req->symbolrate) != stv6120_filter_cf (rp->tunedsr) ;
+		loops = req->symbolrate != rp->tunedsr || req->calibrated != rp->tunedcalibrated ;
+		if (req->freq != rp->tunedfreq || recal)
 		{
-			tempc = KHZ22OFF ;											// defined in stv0910.h	
+			stv6120_retune (rp->nimreceiver, req->freq, req->symbolrate, recal) ;
 		}
-		else
+		stv0910_retune_receive (rp->nimreceiver, req->symbolrate, req->calibrated, loops) ;
+		rp->fastretunes++ ;
+	}
+	else
+	{
+		stv6120_init (rp->nimreceiver, req->freq, req->antenna, req->symbolrate) ;
+		stv0910_setup_receive (rp->nimreceiver, req->symbolrate, req->calibrated) ;
+	}
+	stv0910_start_scan (rp->nimreceiver) ;										// look for a signal
+
+	rp->tunedvalid 		= 1 ;
+	rp->tunedfreq 		= req->freq ;
+	rp->tunedsr 		= req->symbolrate ;
+	rp->tunedcalibrated = req->calibrated ;
+	rp->tunedantenna 	= req->antenna ;
+	rp->tsgate 			= 0 ;
+	rp->tunerequesttime = req->submittime / 1000 ;
+	rp->tuneprogrammed 	= monotime_ms() - rp->tunerequesttime ;
+	if (req->receivetime)
+	{
+		rp->commandtotune = monotime_us() - req->receivetime ;					// command arrival to tuner set up
+		commandtunes++ ;
+		commandtunetime += rp->commandtotune ;
+		if (rp->commandtotune > commandtunemax)
 		{
-			tempc = KHZ22ON ;										
+			commandtunemax = rp->commandtotune ;
 		}
-		err = stv0910_write_reg (RSTV0910_P2_DISTXCFG, tempc) ;		
+	}
+	else if (req->scanstep == 0)
+	{
+		rp->commandtotune = 0 ;
+	}
+	rp->tunetolock 		= 0 ;
+	rp->tunetopacket 	= 0 ;
+	rp->tunereported 	= 0 ;
+	rp->packetpending 	= 0 ;
+	rp->lockpending 	= 1 ;													// watch for lock
+	if (req->scanstep == 0)
+	{
+		rp->freqindex 	  = 0 ;													// a new command: start the scan again
+		rp->srindex 	  = 0 ;
+		rp->scansteps 	  = 0 ;
+		rp->scantime 	  = 0 ;
+		rp->scanstarttime = rp->tunerequesttime ;
+	}
 
-		(void) err ;
+	rp->telemetry.stateread  = 0 ;												// start polling the scan state
+	rp->telemetry.locked 	 = 0 ;
+	rp->telemetry.state 	 = STATE_SEARCH ;
+	rp->telemetry.carfreq 	 = 0 ;
+	rp->telemetry.mer 		 = 0 ;
+	rp->telemetry.symbolrate = req->symbolrate * 1000 ;
+	rp->telemetry.nextpoll [TELEM_STATE] = monotime_ms() ;
+}
 
-// status output
 
-		strcpy (output, "") ;
-	
-		sprintf (output+strlen(output)," RX  STATUS   CALLSIGN           MER      D  FREQUENCY     SR  ") ;
-		sprintf (output+strlen(output),"MODULATION   FPRO  CODE      ANT  PACKETS  ") ;
-		sprintf (output+strlen(output),"%%NUL  NIMTYPE   ") ;
-		sprintf (output+strlen(output),"TS DESTINATION") ;
-		sprintf (output+strlen(output),"\r\n") ;
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 i2c_info_pass
+//@
+//@	 set the voltage generator and 22kHz tone outputs
+//@
+//@	 Calling:	req			the I2CREQ_INFO request
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 
-		sprintf (output+strlen(output)," --------------------------------------------------------------") ;
-		sprintf (output+strlen(output),"-------------------------------------------") ;
-		sprintf (output+strlen(output),"-----------------") ;
-		sprintf (output+strlen(output),"--------------") ;
-		sprintf (output+strlen(output),"\r\n") ;
 
-		strcpy (outputonnet,  output) ;										// for transmission on net
-		strcpy (outputoffnet, output) ;										// for transmission off net
+void i2c_info_pass (struct i2crequest* req)
+{
+///	i2c_write_pic16 (PIC_ADDR_A, 0xc5, req->voltages, req->voltages ^ 0xff) ; 
+	i2c_write_pic8 (PIC_ADDR_A, 0x94, req->voltages) ;
+	i2c_write_pic8 (PIC_ADDR_A, 0x95, req->voltages ^ 0xff) ; 
 
-		strcpy (expandedtextinfo, "") ;
+	GLOBALNIM = NIM_A ;
+	stv0910_write_reg (RSTV0910_P1_DISTXCFG, req->tonex) ;		
+	stv0910_write_reg (RSTV0910_P2_DISTXCFG, req->toney) ;		
+}
 
-        for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)			       
-        {
-			strcpy (output,"") ;											// reset output line
-	   		
-	        if ((rcv[rx].active == 0)) 
-    	    {
-				memset ((void*)&rcv[rx].textinfos, 0, sizeof(rcv[rx].textinfos)) ;
-				rcv[rx].scanstate              = STATE_IDLE ;
-				rcv[rx].rawinfos[STATUS_STATE] = STATE_IDLE ;
-				sprintf (rcv[rx].textinfos[STATUS_STATE], "idle") ;	
-				continue ;
-          	}
-          	else
-          	{
-				y = STATUS_MODECHANGES ;
-				rcv[rx].rawinfos[y] = rcv[rx].modechanges ;				// copy mode changes into infos
-				sprintf (rcv[rx].textinfos[y], "%d", rcv[rx].rawinfos[y]) ;		
-          		if (rcv[rx].ipchanges)									// IP address has changed
-          		{
-          			rcv[rx].ipchanges = 0 ;
-					if (rcv[rx].expinfosock)
-					{
-						sprintf (temps, "$0,%d\r\n$99,1\r\n", rx) ;		// create IP changed info
-		    		    status = sendto 						
-	    		  		(
-	    		  			rcv[rx].expinfosock, (char*)temps, strlen(temps) + 1, 0,
-   			   				(struct sockaddr*) &rcv[rx].expinfosockaddr, sizeof(rcv[x].expinfosockaddr) 
-						) ;
-		    		    status = sendto 							
-	    		  		(
-	    		  			rcv[rx].expinfo2sock, (char*)temps, strlen(temps) + 1, 0,
-   			   				(struct sockaddr*) &rcv[rx].expinfo2sockaddr, sizeof(rcv[x].expinfo2sockaddr) 
-						) ;
-						sprintf (temps, "$0,%d\r\n$99,2\r\n",rx) ;		// send it twice
-	    			    status = sendto 						
-	    		  		(
-		    	  			rcv[rx].expinfosock, (char*)temps, strlen(temps) + 1, 0,
-   				   			(struct sockaddr*) &rcv[rx].expinfosockaddr, sizeof(rcv[rx].expinfosockaddr) 
-						) ;
-	    			    status = sendto 								
-	    		  		(
-		    	  			rcv[rx].expinfo2sock, (char*)temps, strlen(temps) + 1, 0,
-   				   			(struct sockaddr*) &rcv[rx].expinfo2sockaddr, sizeof(rcv[rx].expinfo2sockaddr) 
-						) ;
-					}
-					configsockets (rx, 0) ;							// close all current sockets for this rx
-					strcpy (rcv[rx].ipaddress, rcv[rx].newipaddress) ;
-					strcpy (rcv[rx].newipaddress, "") ;				// copy the new IP address	
-					status = configsockets (rx, 1) ;				// re-open all sockets					
-					if (status != 0)
-					{
-						printf ("Error when re-opening sockets\r\n") ;
-					}
-					rcv[rx].iptype = getiptype (rcv[rx].ipaddress) ;	// see if the commanding IP address is local
-				}							
-				
-				tempc = rcv[rx].scanstate ;
-                GLOBALNIM = rcv[rx].nim ;                                           // set NIM_A or NIM_B
-                y = STATUS_STATE ;                                                  // parameter 1
-				if (rcv[rx].scanstate != STATE_TIMEOUT && rcv[rx].scanstate != STATE_IDLE)   
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 i2c_telemetry_poll
+//@
+//@	 read the telemetry fields which are due into rcv[rx].telemetry
+//@	 while a receiver is searching, only its scan state is read, every pollsearch ms,
+//@	 or every LOCKWATCHPERIOD ms for LOCKWATCHTIME ms after a tune
+//@	 the TS gate of a receiver is opened as soon as its demodulator is seen locked
+//@	 a scanning receiver moves to its next entry when it has not locked within scandwell ms
+//@	 a surveying receiver also moves on after a lock, once the service name has arrived
+//@	 once it has found a header or locked, each field is read every pollperiod[field] ms
+//@	 idle, timed out and stopped receivers are not read at all
+//@	 a new lock is flagged in telemetrylock so that the info loop can report it at once
+//@	 waiting tune requests are performed between receivers
+//@
+//@	 Calling:
+//@
+//@	 Return:	time until the next field is due (ms), INFOPERIOD if none are
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+
+uint32 i2c_telemetry_poll (void)
+{
+		uint32				rx ;
+		uint32				field ;
+		uint32				fields ;
+		uint32				nowms ;
+		uint32				waitms ;
+		int32				duems ;
+		uint8				laststate ;
+		struct telemetry*	tm ;
+
+	waitms = INFOPERIOD ;
+	for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)
+	{
+		if (rcv[rx].active == 0 || rcv[rx].tunedvalid == 0 || 
+			rcv[rx].scanstate == STATE_TIMEOUT || rcv[rx].scanstate == STATE_IDLE)
+		{
+			continue ;
+		}
+
+		i2c_run_queue (I2CTUNE) ;											// let a waiting retune in
+		i2c_run_deferred () ;
+
+		tm 		  = &rcv[rx].telemetry ;
+		GLOBALNIM = rcv[rx].nim ;
+		nowms 	  = monotime_ms() ;
+
+		if ((int32) (nowms - tm->nextpoll [TELEM_STATE]) >= 0)
+		{
+			laststate = tm->state ;
+			stv0910_read_scan_state (rcv[rx].nimreceiver, &tm->state) ;
+			telemetryreads [TELEM_STATE]++ ;
+			tm->stateread = 1 ;
+			if (tm->state == STATE_DEMOD_S2 || tm->state == STATE_DEMOD_S)
+			{
+				if (__atomic_load_n (&i2cqueues[I2CTUNE].in, __ATOMIC_ACQUIRE) == i2cqueues[I2CTUNE].out &&
+					rcv[rx].tunedeferredvalid == 0)
 				{
-    	            stv0910_read_scan_state (rcv[rx].nimreceiver, &tempc) ;        	// get the scan state
-                	if (tempc == STATE_SEARCH)
-                	{
-                		if (rcv[rx].scanstate != STATE_LOST)
-                		{
-                			if (rcv[rx].signalacquiredtime)
-                			{
-		   	            		tempc = STATE_LOST ;
-		   	            		rcv[rx].signallosttime = monotime_ms() ;
-		   	            		rcv[rx].signalacquiredtime = 0 ;					// reset so that next 
-		   	            	}														// aquisition will reset NULLs
-		   	            }
-		   	            else
-		   	            {
-		   	            	tempc = STATE_LOST ;   				   	            	
-						}       	        	
-					}
+					rcv[rx].tsgate = 1 ;									// not about to be retuned
 				}
-       	        rcv[rx].scanstate 	= tempc ;
-           	    rcv[rx].rawinfos[y] = tempc ;				
-                switch (tempc)
-                {
-                    case STATE_IDLE 		: sprintf (rcv[rx].textinfos[y],"idle")    ;  break ;      
-                    case STATE_TIMEOUT		: sprintf (rcv[rx].textinfos[y],"timeout") ;  break ;      
-                    case STATE_LOST 		: sprintf (rcv[rx].textinfos[y],"lost")    ;  break ;      
-                    case STATE_SEARCH 		: sprintf (rcv[rx].textinfos[y],"search")  ;  break ;      
-                    case STATE_HEADER_S2	: sprintf (rcv[rx].textinfos[y],"header")  ;  break ;      
-                    case STATE_DEMOD_S2 	: sprintf (rcv[rx].textinfos[y],"DVB-S2")  ;  break ;    
-                    case STATE_DEMOD_S 		: sprintf (rcv[rx].textinfos[y],"DVB-S")   ;  break ;     
-                    default 			    : sprintf (rcv[rx].textinfos[y],"%s","")   ;  break ;   
-                }
-                
-                y = STATUS_CARRIER_FREQUENCY ;                                      // parameter 6 - frequency
-                stv0910_read_car_freq (rcv[rx].nimreceiver,&temp) ;                 // get the carrier offset               
-				temp /= 1000 ;														// convert to kHz											
-				if (temp == 0)
+				if (rcv[rx].lockpending)
 				{
-///					temp = 1 ;														// prevent zero value
-				}
-				rcv[rx].demodfreq = temp ;											// offset detected by the demodulator
-                if (rcv[rx].scanstate == STATE_DEMOD_S2 || rcv[rx].scanstate  == STATE_DEMOD_S) 
-                {
-					if (rcv[rx].qo100mode == QO100BEACON)							// update loc error
+					rcv[rx].lockpending   = 0 ;
+					rcv[rx].tunetolock 	  = nowms - rcv[rx].tunerequesttime ;
+					rcv[rx].packetpending = 1 ;
+					if ((rcv[rx].enablefreqscan || rcv[rx].enablesrscan) && rcv[rx].surveying == 0)	// the scan has found a signal
 					{
-						tempu 					   = ((rx - 1) & 2) + 1  ;			// 1,2,3,4 --> 1,1,3,3
-						rcv[tempu].qo100locerror   = -temp ;						// first receiver
-						rcv[tempu+1].qo100locerror = -temp ;						// second receiver
-					}                
-                	if (rcv[rx].signalacquiredtime == 0)
-	                {
-						if (rcv[rx].vlcstopped == 0)
-						{
-							memset ((void*)&rcv[rx].rawinfos,0,sizeof(rcv[rx].rawinfos)) ;
-							memset ((void*)&rcv[rx].textinfos,0,sizeof(rcv[rx].textinfos)) ;			
-							rcv[rx].vlcstopped = 1 ;
-							rcv[rx].vlcstopcount++ ;
-							rcv[rx].rawinfos[STATUS_VLCSTOPS] = rcv[rx].vlcstopcount ;
-							if (rcv[rx].xdotoolid)
-							{
-								sprintf (temps,	"xdotool key --window %d s", rcv[rx].xdotoolid) ;
-								system (temps) ;							// send NEXT to VLC
-							}
-						}               
-						rcv[rx].signalacquiredtime = monotime_ms() ;				// signal first acquired
-						rcv[rx].signallosttime    = 0 ;								// clear the lost time
-						rcv[rx].packetcountrx = 0 ;									// clear null packet count
-						rcv[rx].nullpacketcountrx = 0 ;								// clear null packet count
-						y = STATUS_VIDEO_TYPE ;
-						rcv[rx].rawinfos[y]    	  = 0 ;								// clear the service type
-						rcv[rx].textinfos[y][0]	  = 0 ;								
-        	        }
-        		}        
+						rcv[rx].scantime = nowms - rcv[rx].scanstarttime ;
+						printf ("RX%d scan: locked at %d kHz, %d kS after %d steps, %d ms\r\n", rx,
+							rcv[rx].frequencies [rcv[rx].freqindex], rcv[rx].symbolrates [rcv[rx].srindex], 
+							rcv[rx].scansteps, rcv[rx].scantime) ;
+					}
+				}
+			}
+			else
+			{
+				rcv[rx].tsgate = 0 ;
+			}
 
-                y = STATUS_CARRIER_FREQUENCY ;                                      // parameter 6 - frequency
-            	rcv[rx].rawinfos[y]      =  rcv[rx].requestedfreq  ;
-				if (rcv[rx].qo100mode   != QO100BEACON)
+			if (tm->state == STATE_HEADER_S2 || tm->state == STATE_DEMOD_S2 || tm->state == STATE_DEMOD_S)
+			{
+				if (tm->locked == 0)
 				{
-					if (rcv[rx].highsideloc == 0)		
-					{
-						rcv[rx].rawinfos[y] += rcv[rx].demodfreq ;					// adjust the actual frequency
-					}
-					else
+					for (field = TELEM_STATE + 1 ; field < TELEMFIELDS ; field++)
 					{
-						rcv[rx].rawinfos[y] -= rcv[rx].demodfreq ;
+						tm->nextpoll [field] = nowms ;						// read everything now
 					}
+					tm->locked = 1 ;
 				}
+				if (tm->state != laststate && tm->state != STATE_HEADER_S2)
+				{
+					telemetrylock = 1 ;										// new lock
+				}
+				tm->nextpoll [TELEM_STATE] = nowms + pollperiod [TELEM_STATE] ;
+			}
+			else
+			{
+				if (tm->locked)
+				{
+					tm->carfreq = 0 ;										// these are meaningless while searching
+					tm->mer 	= 0 ;
+					tm->locked 	= 0 ;
+				}
+				if (rcv[rx].lockpending && nowms - rcv[rx].tunerequesttime < LOCKWATCHTIME)
+				{
+					tm->nextpoll [TELEM_STATE] = nowms + LOCKWATCHPERIOD ;
+				}
+				else
+				{
+					tm->nextpoll [TELEM_STATE] = nowms + pollsearch ;
+				}
+			}
 
-                y = STATUS_CARRIER_FREQUENCY ;                                      // parameter 6 - frequency
-                sprintf (rcv[rx].textinfos[y], "%0.3f" ,(float)rcv[rx].rawinfos[y] / 1000) ;  	// frequency in MHz    
-
-                y = STATUS_SYMBOL_RATE ;                                            // parameter 9
-                stv0910_read_sr (rcv[rx].nimreceiver,&tempu) ;                      // get the symbol rate               
-                rcv[rx].rawinfos[y] = tempu ;
-                sprintf (rcv[rx].textinfos[y], "%d" ,(tempu + 500) / 1000) ;    	// symbol rate in kS  
-                
-                y = STATUS_MER ;                                                    // parameter 12  
-                stv0910_read_mer (rcv[rx].nimreceiver,&temp) ;                      // get the MER in 0.1dB units               
-                rcv[rx].rawinfos[y] = temp ;										
-                if (temp > 999)
-                {
-					temp = 999 ;
-                }
-                else if (temp < -999)
-                {
-					temp = -999 ;
-                }
-                sprintf (rcv[rx].textinfos[y], "%.1f" ,((float) temp) / 10) ;		// MER  
+			if (rcv[rx].lockpending && (rcv[rx].enablefreqscan || rcv[rx].enablesrscan || rcv[rx].surveying))
+			{
+				duems = scandwell ;
+				if (tm->state == STATE_HEADER_S2)
+				{
+					duems *= 2 ;											// give a DVB-S2 header time to lock
+				}
+				if (nowms - rcv[rx].tunerequesttime >= (uint32) duems)
+				{
+					i2c_scan_step (rx) ;									// nothing here: try the next entry
+				}
+			}
+			else if (rcv[rx].surveying && rcv[rx].surveydone == 0 && rcv[rx].lockpending == 0)
+			{
+				if 
+				(
+					(rcv[rx].textinfos[STATUS_SERVICE_NAME][0] && 
+						rcv[rx].psiclearsdone == __atomic_load_n (&rcv[rx].psiclears, __ATOMIC_ACQUIRE)) || 
+					nowms - rcv[rx].tunerequesttime - rcv[rx].tunetolock >= SURVEYNAMETIME
+				)
+				{
+					i2c_survey_record (rx) ;								// a signal: note it and move on
+					i2c_scan_step (rx) ;
+				}
+			}
+		}
 
-           	    if (rcv[rx].scanstate == STATE_HEADER_S2 || rcv[rx].scanstate == STATE_DEMOD_S2) // DVB-S2 header or lock
-                {                    
-                    y = STATUS_MODCOD ;                                    			// parameter 18
-                    stv0910_read_modcod_and_type 
-                    (
-                    	rcv[rx].nimreceiver, &tempu, &bool1, &bool2  				// modcod, frametype, pilots
-					) ;
-					if (tempu == rcv[rx].lastmodulation)							// check for consecutive similar
+		fields = tm->locked ? TELEMFIELDS : TELEM_STATE + 1 ;
+		for (field = TELEM_STATE + 1 ; field < fields ; field++)
+		{
+			if ((int32) (nowms - tm->nextpoll [field]) < 0)
+			{
+				continue ;
+			}
+			switch (field)
+			{
+				case TELEM_FREQ :
+					stv0910_read_car_freq (rcv[rx].nimreceiver, &tm->carfreq) ;
+					telemetryreads [field]++ ;
+					break ;
+
+				case TELEM_SR :
+					stv0910_read_sr (rcv[rx].nimreceiver, &tm->symbolrate) ;
+					telemetryreads [field]++ ;
+					break ;
+
+				case TELEM_MER :
+					stv0910_read_mer (rcv[rx].nimreceiver, &tm->mer) ;
+					telemetryreads [field]++ ;
+					break ;
+
+				case TELEM_MODCOD :
+					if (tm->state == STATE_DEMOD_S)
 					{
-	                    rcv[rx].rawinfos[y] = tempu ;
-    	                sprintf (rcv[rx].textinfos[y], "%s" , modinfo_S2[tempu].modtext) ; 			// qpsk 3/4 etc 
-	                    y = STATUS_DNUMBER ; 														// decode threshold
-						temp = rcv[rx].rawinfos[STATUS_MER] - modinfo_S2[tempu].minmer ;
-	                    rcv[rx].rawinfos[y] = temp ; 
-    	                sprintf (rcv[rx].textinfos[y], "%.1f" , (float) temp / 10) ;
-
-	                    y = STATUS_FRAME_TYPE ;                                         			// parameter 19
-    	                rcv[rx].rawinfos[y] = (bool1 ? 1 : 0) ;
-						if (rcv[rx].rawinfos[y])
-						{	
-							sprintf (rcv[rx].textinfos[y], "S") ;
-						}
-						else
-						{	
-							sprintf (rcv[rx].textinfos[y], "L") ;
-						}
-	
-    	                y = STATUS_PILOTS ;                                             			// parameter 20
-	                    rcv[rx].rawinfos[y] = (bool2 ? 1 : 0) ;                                    
-						if (rcv[rx].rawinfos[y])
-						{	
-							sprintf (rcv[rx].textinfos[y], "Y") ;
-						}
-						else
-						{	
-							sprintf (rcv[rx].textinfos[y], "N") ;
-						}
-	
-						y = STATUS_ROLLOFF ;
-	    	            stv0910_read_rolloff (rcv[rx].nimreceiver,&tempu) ; 		                // get the rolloff               
-						rcv[rx].rawinfos[y] = tempu ;
-						switch (rcv[rx].rawinfos[y])
-						{
-							case 0 : sprintf (rcv[rx].textinfos[y],"35") ; break ;
-							case 1 : sprintf (rcv[rx].textinfos[y],"25") ; break ;
-							case 2 : sprintf (rcv[rx].textinfos[y],"20") ; break ;
-							case 3 : sprintf (rcv[rx].textinfos[y],"15") ; break ;
-						} ;
+						stv0910_read_puncture_rate (rcv[rx].nimreceiver, &tm->puncture) ;
 					}
 					else
 					{
-						rcv[rx].lastmodulation = tempu ;
+						stv0910_read_modcod_and_type (rcv[rx].nimreceiver, &tm->modcod, &tm->shortframe, &tm->pilots) ;
 					}
+					telemetryreads [field]++ ;
+					break ;
 
-                }
-                else if (rcv[rx].scanstate == STATE_DEMOD_S)									// DVB-S
-                {
-                    y = STATUS_MODCOD ;                                             			// parameter 18
-					stv0910_read_puncture_rate (rcv[rx].nimreceiver,&tempc) ;
-					rcv[rx].rawinfos[y] = 100 + tempc ;
-					sprintf (rcv[rx].textinfos[y], "%s", modinfo_S[tempc].modtext) ;
-
-					if (tempc == rcv[rx].lastmodulation)							// check for consecutive similar
-					{
-	                    y = STATUS_DNUMBER ; 														// decode threshold
-						temp = rcv[rx].rawinfos[STATUS_MER] - modinfo_S[tempc].minmer ;
-                    	rcv[rx].rawinfos[y] = temp ; 
-                    	sprintf (rcv[rx].textinfos[y], "%.1f" , (float) temp / 10) ;
-                    }
-					else
+				case TELEM_ROLLOFF :
+					if (tm->state != STATE_DEMOD_S)							// DVB-S2 only
 					{
-						rcv[rx].lastmodulation = tempc ;
+						stv0910_read_rolloff (rcv[rx].nimreceiver, &tm->rolloff) ;
+						telemetryreads [field]++ ;
 					}
-                }
-                else 																			// set some parameters to default
-                {
-/*                
-	                y = STATUS_MODCOD ;                                         				// parameter 18
-                    rcv[rx].rawinfos[y] = 0 ;
-       	            sprintf (rcv[rx].textinfos[y],"%s","") ;                               
-                
-	                y = STATUS_FRAME_TYPE ;                                     				// parameter 19
-                    rcv[rx].rawinfos[y] = 0 ;
+					break ;
+			}
+			tm->nextpoll [field] = nowms + pollperiod [field] ;
+		}
+
+		for (field = TELEM_STATE ; field < fields ; field++)				// when is the next field due
+		{
+			duems = tm->nextpoll [field] - nowms ;
+			if (duems < 0)
+			{
+				duems = 0 ;
+			}
+			if ((uint32) duems < waitms)
+			{
+				waitms = duems ;
+			}
+		}
+	}
+
+	return (waitms) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 i2c_scan_step
+//@
+//@	 retune a scanning receiver to the next entry of its scan lists
+//@	 all the symbol rates are tried on a frequency before moving to the next frequency
+//@	 the scan wraps round until the receiver locks or is given a new command
+//@	 a band survey does not wrap: the receiver's part is complete after the last entry
+//@
+//@	 Calling:	rx			receiver number
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+
+void i2c_scan_step (uint32 rx)
+{
+		struct rxcontrol*	rp ;
+		struct i2crequest	req ;
+
+	rp = &rcv[rx] ;
+	rp->srindex++ ;
+	if (rp->srindex >= rp->srcount)
+	{
+		rp->srindex = 0 ;
+		rp->freqindex++ ;
+		if (rp->freqindex >= rp->freqcount)
+		{
+			rp->freqindex = 0 ;
+			if (rp->surveying)
+			{
+				rp->surveytime  = monotime_ms() - surveystarttime ;
+				rp->lockpending = 0 ;
+				rp->surveydone  = 1 ;											// stopped by survey_finish
+				return ;
+			}
+		}
+	}
+	if (rp->surveying)
+	{
+		rp->psiclearname = 1 ;														// wait for the new name
+		psi_cache_clear (rx) ;
+	}
+
+	rp->requestedfreq = rp->frequencies [rp->freqindex] ;						// reported with the demodulator offset
+	rp->hardwarefreq  = abs ((int32) rp->requestedfreq - (int32) rp->requestedloc) ;
+	if (rp->qo100mode == QO100BAND)
+	{
+		rp->hardwarefreq -= rp->qo100locerror ;
+	}
+
+	memset (&req, 0, sizeof(req)) ;
+	req.type 		= I2CREQ_TUNE ;
+	req.rx 			= rx ;
+	req.freq 		= rp->hardwarefreq ;
+	req.antenna 	= rp->antenna ;
+	req.symbolrate 	= rp->symbolrates [rp->srindex] ;
+	req.calibrated 	= rp->tunedcalibrated ;
+	req.scanstep 	= 1 ;
+	req.submittime 	= monotime_us() ;
+	i2c_tune (&req) ;
+
+	rp->telemetry.nextpoll [TELEM_STATE] = monotime_ms() + LOCKWATCHPERIOD ;
+	rp->scansteps++ ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 i2c_survey_record
+//@
+//@	 add the signal a surveying receiver has locked to, to the survey results
+//@
+//@	 Calling:	rx			receiver number
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+
+void i2c_survey_record (uint32 rx)
+{
+		struct surveyresult*	sp ;
+		int32					offset ;
+
+	if (surveyresultcount >= MAXSURVEYRESULTS)
+	{
+		return ;
+	}
+
+	sp 	   = &surveyresults [surveyresultcount] ;
+	offset = rcv[rx].telemetry.carfreq / 1000 ;
+	sp->rx 			= rx ;
+	sp->freq 		= rcv[rx].frequencies [rcv[rx].freqindex] + (rcv[rx].highsideloc ? -offset : offset) ;
+	sp->symbolrate 	= (rcv[rx].telemetry.symbolrate + 500) / 1000 ;
+	sp->mer 		= rcv[rx].telemetry.mer ;
+	strncpy (sp->name, rcv[rx].textinfos [STATUS_SERVICE_NAME], sizeof(sp->name) - 1) ;
+	sp->name [sizeof(sp->name) - 1] = 0 ;
+	__atomic_store_n (&surveyresultcount, surveyresultcount + 1, __ATOMIC_RELEASE) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 i2c_constellation
+//@
+//@	 one constellation bus slot: read CONSTPAIRS I/Q pairs from the next capturing receiver
+//@	 and send them as one frame to its constellation port
+//@	 the frame is a CONSTHEADER byte header followed by the pairs as signed bytes, I then Q
+//@	 the slots of the capturing receivers take turns; tune requests and telemetry are served between slots
+//@	 a capture stops CONSTTIMEOUT ms after the last request
+//@
+//@	 Calling:
+//@
+//@	 Return:	1 if a slot was used, 0 if no capture is running
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+
+uint32 i2c_constellation (void)
+{
+		uint32				n ;
+		uint32				rx ;
+		uint32				pair ;
+		uint8				frame [CONSTHEADER + CONSTPAIRS * 2] ;
+		struct sockaddr_in	dest ;
+static	uint32				lastrx ;
+
+	for (n = 1 ; n <= MAXRECEIVERS ; n++)
+	{
+		rx = (lastrx + n - 1) % MAXRECEIVERS + 1 ;						// the receiver after the last one served
+		if (rcv[rx].constcapture == 0)
+		{
+			continue ;
+		}
+		if (monotime_ms() - rcv[rx].constrequesttime >= CONSTTIMEOUT)
+		{
+			rcv[rx].constcapture = 0 ;									// no client has asked for a while
+			printf ("RX%d constellation capture stopped after %u frames\r\n", rx, rcv[rx].constsequence) ;
+			continue ;
+		}
+		if (rcv[rx].active == 0 || rcv[rx].tunedvalid == 0 || rcv[rx].telemetry.locked == 0 || rcv[rx].constsock == 0)
+		{
+			continue ;
+		}
+
+		dest = rcv[rx].constsockaddr ;										// the address can change in info_loop
+		dest.sin_addr.s_addr = __atomic_load_n (&rcv[rx].constsockaddr.sin_addr.s_addr, __ATOMIC_RELAXED) ;
+		if (dest.sin_addr.s_addr == INADDR_ANY)
+		{
+			continue ;															// no command has set an address yet
+		}
+
+		GLOBALNIM = rcv[rx].nim ;
+		for (pair = 0 ; pair < CONSTPAIRS ; pair++)
+		{
+			stv0910_read_constellation (rcv[rx].nimreceiver, &frame [CONSTHEADER + pair * 2], &frame [CONSTHEADER + pair * 2 + 1]) ;
+		}
+		rcv[rx].constlast [0] = frame [CONSTHEADER + CONSTPAIRS * 2 - 2] ;
+		rcv[rx].constlast [1] = frame [CONSTHEADER + CONSTPAIRS * 2 - 1] ;
+
+		frame [0] = 'W' ;
+		frame [1] = 'H' ;
+		frame [2] = 'C' ;
+		frame [3] = rx ;
+		frame [4] = rcv[rx].constsequence >> 8 ;
+		frame [5] = rcv[rx].constsequence ;
+		frame [6] = CONSTPAIRS >> 8 ;
+		frame [7] = CONSTPAIRS & 0xff ;
+		sendto 
+		(
+			rcv[rx].constsock, frame, sizeof(frame), MSG_DONTWAIT,
+			(struct sockaddr*) &dest, sizeof(dest) 
+		) ;
+		rcv[rx].constsequence++ ;
+
+		lastrx = rx ;
+		return (1) ;
+	}
+
+	return (0) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 i2c_wait
+//@
+//@	 wait for an I2C request to be queued, or until a time has passed
+//@	 the time is kept on the monotonic clock, so that setting the clock neither stalls nor
+//@	 hurries the telemetry poll; without sem_clockwait (glibc before 2.30, as on Buster)
+//@	 the realtime deadline is worked out again from the monotonic time every I2CWAITSLICE ms
+//@
+//@	 Calling:	waitms		longest wait (ms)
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void i2c_wait (uint32 waitms)
+{
+		struct timespec		ts ;
+#if !defined(__GLIBC_PREREQ) || !__GLIBC_PREREQ(2,30)
+		uint32				startms ;
+		uint32				elapsedms ;
+		uint32				slicems ;
+#endif
+
+#if defined(__GLIBC_PREREQ) && __GLIBC_PREREQ(2,30)
+	clock_gettime (CLOCK_MONOTONIC, &ts) ;
+	ts.tv_sec  += waitms / 1000 ;
+	ts.tv_nsec += (waitms % 1000) * 1000000 ;
+	if (ts.tv_nsec >= 1000000000)
+	{
+		ts.tv_sec++ ;
+		ts.tv_nsec -= 1000000000 ;
+	}
+	sem_clockwait (&i2csem, CLOCK_MONOTONIC, &ts) ;
+#else
+	startms = monotime_ms() ;
+	do
+	{
+		elapsedms = monotime_ms() - startms ;
+		slicems   = waitms - elapsedms < I2CWAITSLICE ? waitms - elapsedms : I2CWAITSLICE ;
+		if (elapsedms > waitms)
+		{
+			slicems = 0 ;
+		}
+		clock_gettime (CLOCK_REALTIME, &ts) ;
+		ts.tv_nsec += slicems * 1000000 ;
+		if (ts.tv_nsec >= 1000000000)
+		{
+			ts.tv_sec++ ;
+			ts.tv_nsec -= 1000000000 ;
+		}
+		if (sem_timedwait (&i2csem, &ts) == 0)
+		{
+			break ;													// a request has been queued
+		}
+	} while (monotime_ms() - startms < waitms) ;
+#endif
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 i2c_loop
+//@
+//@	 the I2C thread, which makes all I2C accesses after startup
+//@	 tune requests are performed before info requests, then the telemetry fields which are due,
+//@	 then one constellation slot if a capture is running
+//@	 the thread sleeps until a request is queued or the next telemetry field is due
+//@
+//@	 Calling:
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+
+void* i2c_loop (void* dummy)
+{
+		uint32				waitms ;
+		uint32				tempu ;
+
+	(void) dummy ;
+
+	while (i2cserviceenabled == 0)
+	{
+		usleep (1000) ;
+	}
+
+	waitms = 0 ;
+	while (i2cserviceenabled == 1)
+	{
+		i2c_wait (waitms) ;
+		i2c_run_queue (I2CTUNE) ;
+		i2c_run_queue (I2CINFO) ;
+		waitms = i2c_telemetry_poll () ;
+		tempu  = i2c_run_deferred () ;
+		if (tempu < waitms)
+		{
+			waitms = tempu ;											// a held back tune is due
+		}
+		if (i2c_constellation ())
+		{
+			waitms = 0 ;												// capture again after the other work
+		}
+	}
+
+	printf ("I2C    thread exiting\r\n") ;
+	return (0) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 i2cqueue_print_stats
+//@
+//@	 print the queueing delay for each I2C request class and the number of telemetry reads
+//@
+//@	 Calling:
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+
+void i2cqueue_print_stats (void)
+{
+		uint32		class ;
+static	const char*	names [I2CCLASSES] = {"tune", "info"} ;
+
+	for (class = 0 ; class < I2CCLASSES ; class++)
+	{
+		printf ("I2C requests (%s): %u, average wait %llu us, longest %u us\r\n", names [class], i2cwaits [class],
+			(unsigned long long) (i2cwaits [class] ? i2cwaittime [class] / i2cwaits [class] : 0), i2cwaitmax [class]) ;
+	}
+	printf ("Telemetry reads: state %u, freq %u, sr %u, mer %u, modcod %u, rolloff %u\r\n",
+		telemetryreads [TELEM_STATE], telemetryreads [TELEM_FREQ], telemetryreads [TELEM_SR],
+		telemetryreads [TELEM_MER], telemetryreads [TELEM_MODCOD], telemetryreads [TELEM_ROLLOFF]) ;
+	printf ("Tune commands: %u, average command to tuner set up %llu us, longest %u us; main loop wakeups %u\r\n",
+		commandtunes, (unsigned long long) (commandtunes ? commandtunetime / commandtunes : 0), commandtunemax, mainwakeups) ;
+	printf ("Tune requests superseded: RX1 %u, RX2 %u, RX3 %u, RX4 %u\r\n",
+		rcv[1].tunesuperseded, rcv[2].tunesuperseded, rcv[3].tunesuperseded, rcv[4].tunesuperseded) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 a thread to to send commands from the .ini file        
+//@
+//@	 Calling:	
+//@
+//@	 Return:	
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void* inicommand_loop (void* dummy)
+{	
+	uint32		x ;
+	uint32		tempu ;
+	int32		status ;
+	(void)		dummy ;
+	
+	while (inicommandenabled == 0) 
+	{
+		usleep (1000) ;
+	}
+
+	if (inicommandcount)
+	{
+		printf ("Sending ini file commands\r\n") ;
+		for (x = 0 ; x < inicommandcount ; x++)
+		{
+    		if ((strlen(inicommands[x]) == 1) && isdigit(inicommands[x][0]))	// single digit
+    		{
+				tempu = inicommands[x][0] & 0xf ;
+				printf ("Delaying %d seconds\r\n", tempu) ;
+				usleep (tempu * 1000 * 1000) ;				// delay tempu seconds
+    		}
+			else
+			{
+	    		printf ("%s\r\n", inicommands[x]) ;
+    			status = sendto
+    			(
+		    		rcv[0].tssock, inicommands[x], strlen(inicommands[x]) + 1, 0,
+			        (struct sockaddr*) &rcv[0].listensockaddr, sizeof(rcv[0].listensockaddr)
+    			) ;
+    			(void) status ;
+	    		usleep (100 * 1000) ;
+    		}
+    	}
+	}
+	return (0) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 a thread to check if it's time for an info output        
+//@  display the receiver summary and sent info via udp
+//@
+//@	 Calling:	
+//@
+//@	 Return:	
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void* info_loop (void* dummy)
+{
+		uint32			rx ;
+		uint32			x ;
+		uint32			y ;
+		char			titlebar [4096] ;
+		char			temps    [5000] ;
+		char			temps2   [4096] ;
+		char			temps3   [64] ;
+		bool			bool1 ;
+		bool			bool2 ;
+		uint8			tempc ;	
+		int32			temp ;
+		uint32			tempu ;
+		char			command       [256] ;
+		char			output   	  [4096] ;
+		char			outputonnet   [4096] ;
+		char			outputoffnet  [4096] ;
+		int32			status ;
+static	uint32			counter ;
+static	uint32			lastreadcount ;
+static	uint32			lastreadpackets ;
+static	uint32			lasti2caccesses ;
+static	uint64_t		lasti2caccesstime ;
+static	uint32			lasti2cwaits 	[I2CCLASSES] ;
+static	uint64_t		lasti2cwaittime [I2CCLASSES] ;
+		struct i2crequest	i2creq ;
+		uint32			thenms ;
+		struct in_addr	sia ;
+	
+  		(void) dummy ;
+
+
+	while (lminfoutenabled == 0) 
+	{
+		usleep (1000) ;
+	}
+
+   	thenms = monotime_ms() ;											// current time
+	while (lminfoutenabled == 1)
+    {    
+
+		while ((monotime_ms() - thenms) < INFOPERIOD && telemetrylock == 0)
+		{
+       		usleep (10 * 1000) ; 										// sleep 10ms
+       	}
+		if (telemetrylock)												// report a new lock at once
+		{
+			telemetrylock = 0 ;
+			thenms = monotime_ms() ;
+		}
+		else
+		{
+			thenms += INFOPERIOD ;
+		}
+
+		counter++ ;														// for EIT injection
+
+// output voltage commands
+
+		tempc = 0 ;
+		if (vgxen)  tempc |= 0x01 ;
+		if (vgxsel) tempc |= 0x04 ;
+		if (vgyen)  tempc |= 0x10 ;
+		if (vgysel) tempc |= 0x40 ;
+		tempc |= 0xaa ;													// turn on the valid bit for each item		
+		i2creq.voltages = tempc ;
+
+// output 22kHz commands
+
+		if (vgxtone == 0)
+		{
+			tempc = KHZ22OFF ;											// defined in stv0910.h	
+		}
+		else
+		{
+			tempc = KHZ22ON ;										
+		}
+		i2creq.tonex = tempc ;
+
+		if (vgytone == 0)
+		{
+			tempc = KHZ22OFF ;											// defined in stv0910.h	
+		}
+		else
+		{
+			tempc = KHZ22ON ;										
+		}
+		i2creq.toney = tempc ;
+
+// the I2C thread sets the outputs; it reads the demodulators into rcv[rx].telemetry by itself
+
+		i2creq.type = I2CREQ_INFO ;
+		tempu = i2c_submit (I2CINFO, &i2creq) ;
+		while (i2cqueues[I2CINFO].out != tempu && i2cserviceenabled == 1)
+		{
+			usleep (1000) ;
+		}
+
+// status output
+
+		strcpy (output, "") ;
+	
+		sprintf (output+strlen(output)," RX  STATUS   CALLSIGN           MER      D  FREQUENCY     SR  ") ;
+		sprintf (output+strlen(output),"MODULATION   FPRO  CODE      ANT  PACKETS  ") ;
+		sprintf (output+strlen(output),"%%NUL  NIMTYPE   ") ;
+		sprintf (output+strlen(output),"TS DESTINATION") ;
+		sprintf (output+strlen(output),"\r\n") ;
+
+		sprintf (output+strlen(output)," --------------------------------------------------------------") ;
+		sprintf (output+strlen(output),"-------------------------------------------") ;
+		sprintf (output+strlen(output),"-----------------") ;
+		sprintf (output+strlen(output),"--------------") ;
+		sprintf (output+strlen(output),"\r\n") ;
+
+		strcpy (outputonnet,  output) ;										// for transmission on net
+		strcpy (outputoffnet, output) ;										// for transmission off net
+
+		strcpy (expandedtextinfo, "") ;
+
+        for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)			       
+        {
+			strcpy (output,"") ;											// reset output line
+	   		
+	        if ((rcv[rx].active == 0)) 
+    	    {
+				memset ((void*)&rcv[rx].textinfos, 0, sizeof(rcv[rx].textinfos)) ;
+				rcv[rx].scanstate              = STATE_IDLE ;
+				rcv[rx].rawinfos[STATUS_STATE] = STATE_IDLE ;
+				sprintf (rcv[rx].textinfos[STATUS_STATE], "idle") ;	
+				continue ;
+          	}
+          	else
+          	{
+				y = STATUS_MODECHANGES ;
+				rcv[rx].rawinfos[y] = rcv[rx].modechanges ;				// copy mode changes into infos
+				sprintf (rcv[rx].textinfos[y], "%d", rcv[rx].rawinfos[y]) ;		
+
+				y = STATUS_TS_DGRAMS_PER_CALL ;							// TS output statistics
+				tempu = rcv[rx].tssyscalls - rcv[rx].tslastsyscalls ;
+				temp  = rcv[rx].tsdatagrams - rcv[rx].tslastdatagrams ;
+				rcv[rx].tslastsyscalls  = rcv[rx].tssyscalls ;
+				rcv[rx].tslastdatagrams = rcv[rx].tsdatagrams ;
+				if (tempu)
+				{
+					rcv[rx].rawinfos[y] = (temp + tempu / 2) / tempu ;
+					sprintf (rcv[rx].textinfos[y], "%.1f", (float) temp / tempu) ;
+				}
+				else
+				{
+					rcv[rx].rawinfos[y] = 0 ;								// nothing sent since the last info output
+					sprintf (rcv[rx].textinfos[y], "0.0") ;
+				}
+				y = STATUS_TS_DROPS ;
+				rcv[rx].rawinfos[y] = rcv[rx].tsdrops ;
+				sprintf (rcv[rx].textinfos[y], "%d", rcv[rx].rawinfos[y]) ;		
+				y = STATUS_TS_SUBSCRIBERS ;								// extra TS destinations: ip:port sent/dropped
+				rcv[rx].rawinfos[y]   = 0 ;
+				rcv[rx].textinfos[y][0] = 0 ;
+				for (x = 0 ; x < MAXSUBSCRIBERS ; x++)
+				{
+					if (rcv[rx].subscribers[x].active)
+					{
+						sprintf (&rcv[rx].textinfos[y][strlen(rcv[rx].textinfos[y])], "%s%s:%d %u/%u",
+							rcv[rx].rawinfos[y] ? ", " : "", inet_ntoa (rcv[rx].subscribers[x].addr.sin_addr),
+							ntohs (rcv[rx].subscribers[x].addr.sin_port),
+							rcv[rx].subscribers[x].countgeneration == rcv[rx].subscribers[x].generation ? rcv[rx].subscribers[x].datagrams : 0,
+							rcv[rx].subscribers[x].countgeneration == rcv[rx].subscribers[x].generation ? rcv[rx].subscribers[x].drops : 0) ;
+						rcv[rx].rawinfos[y]++ ;
+					}
+				}
+				y = STATUS_PSI_HITS ;									// PSI sections skipped / parsed
+				rcv[rx].rawinfos[y] = rcv[rx].psihits ;
+				sprintf (rcv[rx].textinfos[y], "%d", rcv[rx].rawinfos[y]) ;		
+				y = STATUS_PSI_MISSES ;
+				rcv[rx].rawinfos[y] = rcv[rx].psimisses ;
+				sprintf (rcv[rx].textinfos[y], "%d", rcv[rx].rawinfos[y]) ;		
+				y = STATUS_TUNE_TO_LOCK ;								// retune statistics
+				rcv[rx].rawinfos[y] = rcv[rx].tunetolock ;
+				sprintf (rcv[rx].textinfos[y], "%d", rcv[rx].rawinfos[y]) ;		
+				y = STATUS_FAST_RETUNES ;
+				rcv[rx].rawinfos[y] = rcv[rx].fastretunes ;
+				sprintf (rcv[rx].textinfos[y], "%d", rcv[rx].rawinfos[y]) ;		
+				if (rcv[rx].constcapture)								// the last constellation point captured
+				{
+					y = STATUS_CONSTELLATION_I ;
+					rcv[rx].rawinfos[y] = (int8_t) rcv[rx].constlast [0] ;
+					sprintf (rcv[rx].textinfos[y], "%d", rcv[rx].rawinfos[y]) ;		
+					y = STATUS_CONSTELLATION_Q ;
+					rcv[rx].rawinfos[y] = (int8_t) rcv[rx].constlast [1] ;
+					sprintf (rcv[rx].textinfos[y], "%d", rcv[rx].rawinfos[y]) ;		
+				}
+				y = STATUS_SCAN_STEPS ;									// scan progress
+				rcv[rx].rawinfos[y] = rcv[rx].scansteps ;
+				sprintf (rcv[rx].textinfos[y], "%d", rcv[rx].rawinfos[y]) ;		
+				y = STATUS_SCAN_TIME ;
+				rcv[rx].rawinfos[y] = rcv[rx].scantime ;
+				sprintf (rcv[rx].textinfos[y], "%d", rcv[rx].rawinfos[y]) ;		
+				y = STATUS_TUNE_PROGRAMMED ;							// timeline of the last tune
+				rcv[rx].rawinfos[y] = rcv[rx].tuneprogrammed ;
+				sprintf (rcv[rx].textinfos[y], "%d", rcv[rx].rawinfos[y]) ;		
+				y = STATUS_TUNE_TO_PACKET ;
+				rcv[rx].rawinfos[y] = rcv[rx].tunetopacket ;
+				sprintf (rcv[rx].textinfos[y], "%d", rcv[rx].rawinfos[y]) ;		
+				y = STATUS_COMMAND_TO_TUNE ;
+				rcv[rx].rawinfos[y] = rcv[rx].commandtotune ;
+				sprintf (rcv[rx].textinfos[y], "%d", rcv[rx].rawinfos[y]) ;		
+				y = STATUS_TUNES_SUPERSEDED ;
+				rcv[rx].rawinfos[y] = rcv[rx].tunesuperseded ;
+				sprintf (rcv[rx].textinfos[y], "%d", rcv[rx].rawinfos[y]) ;		
+				if (rcv[rx].tunetopacket && rcv[rx].tunereported == 0)
+				{
+					rcv[rx].tunereported = 1 ;
+					printf ("RX%d tune: command to tuner set up %d us, programmed %d ms, locked %d ms, first packet %d ms\r\n", rx,
+						rcv[rx].commandtotune, rcv[rx].tuneprogrammed, rcv[rx].tunetolock, rcv[rx].tunetopacket) ;
+				}
+          		if (rcv[rx].ipchanges)									// IP address has changed
+          		{
+          			rcv[rx].ipchanges = 0 ;
+					if (rcv[rx].expinfosock)
+					{
+						sprintf (temps, "$0,%d\r\n$99,1\r\n", rx) ;		// create IP changed info
+		    		    status = sendto 						
+	    		  		(
+	    		  			rcv[rx].expinfosock, (char*)temps, strlen(temps) + 1, 0,
+   			   				(struct sockaddr*) &rcv[rx].expinfosockaddr, sizeof(rcv[x].expinfosockaddr) 
+						) ;
+		    		    status = sendto 							
+	    		  		(
+	    		  			rcv[rx].expinfo2sock, (char*)temps, strlen(temps) + 1, 0,
+   			   				(struct sockaddr*) &rcv[rx].expinfo2sockaddr, sizeof(rcv[x].expinfo2sockaddr) 
+						) ;
+						sprintf (temps, "$0,%d\r\n$99,2\r\n",rx) ;		// send it twice
+	    			    status = sendto 						
+	    		  		(
+		    	  			rcv[rx].expinfosock, (char*)temps, strlen(temps) + 1, 0,
+   				   			(struct sockaddr*) &rcv[rx].expinfosockaddr, sizeof(rcv[rx].expinfosockaddr) 
+						) ;
+	    			    status = sendto 								
+	    		  		(
+		    	  			rcv[rx].expinfo2sock, (char*)temps, strlen(temps) + 1, 0,
+   				   			(struct sockaddr*) &rcv[rx].expinfo2sockaddr, sizeof(rcv[rx].expinfo2sockaddr) 
+						) ;
+					}
+					configsockets (rx, 0, 0) ;						// close all current sockets for this rx
+					strcpy (rcv[rx].ipaddress, rcv[rx].newipaddress) ;
+					strcpy (rcv[rx].newipaddress, "") ;				// copy the new IP address	
+					status = configsockets (rx, 1, 0) ;			// re-open all but the fixed sockets
+					__atomic_store_n 							// the constellation goes to the new address
+					(
+						&rcv[rx].constsockaddr.sin_addr.s_addr, inet_addr (rcv[rx].ipaddress), __ATOMIC_RELAXED
+					) ;					
+					if (status != 0)
+					{
+						printf ("Error when re-opening sockets\r\n") ;
+					}
+					rcv[rx].iptype = getiptype (rcv[rx].ipaddress) ;	// see if the commanding IP address is local
+					__atomic_fetch_add (&rcv[rx].pidtablechanges, 1, __ATOMIC_RELEASE) ;
+				}							
+				
+				tempc = rcv[rx].scanstate ;
+                y = STATUS_STATE ;                                                  // parameter 1
+				if (rcv[rx].scanstate != STATE_TIMEOUT && rcv[rx].scanstate != STATE_IDLE && rcv[rx].telemetry.stateread)   
+				{
+    	            tempc = rcv[rx].telemetry.state ;        						// the scan state
+                	if (tempc == STATE_SEARCH)
+                	{
+                		if (rcv[rx].scanstate != STATE_LOST)
+                		{
+                			if (rcv[rx].signalacquiredtime)
+                			{
+		   	            		tempc = STATE_LOST ;
+		   	            		rcv[rx].signallosttime = monotime_ms() ;
+		   	            		rcv[rx].signalacquiredtime = 0 ;					// reset so that next 
+		   	            	}														// aquisition will reset NULLs
+		   	            }
+		   	            else
+		   	            {
+		   	            	tempc = STATE_LOST ;   				   	            	
+						}       	        	
+					}
+				}
+       	        rcv[rx].scanstate 	= tempc ;
+           	    rcv[rx].rawinfos[y] = tempc ;				
+                switch (tempc)
+                {
+                    case STATE_IDLE 		: sprintf (rcv[rx].textinfos[y],"idle")    ;  break ;      
+                    case STATE_TIMEOUT		: sprintf (rcv[rx].textinfos[y],"timeout") ;  break ;      
+                    case STATE_LOST 		: sprintf (rcv[rx].textinfos[y],"lost")    ;  break ;      
+                    case STATE_SEARCH 		: sprintf (rcv[rx].textinfos[y],"search")  ;  break ;      
+                    case STATE_HEADER_S2	: sprintf (rcv[rx].textinfos[y],"header")  ;  break ;      
+                    case STATE_DEMOD_S2 	: sprintf (rcv[rx].textinfos[y],"DVB-S2")  ;  break ;    
+                    case STATE_DEMOD_S 		: sprintf (rcv[rx].textinfos[y],"DVB-S")   ;  break ;     
+                    default 			    : sprintf (rcv[rx].textinfos[y],"%s","")   ;  break ;   
+                }
+                
+                y = STATUS_CARRIER_FREQUENCY ;                                      // parameter 6 - frequency
+                temp = rcv[rx].telemetry.carfreq ;                 					// the carrier offset               
+				temp /= 1000 ;														// convert to kHz											
+				if (temp == 0)
+				{
+///					temp = 1 ;														// prevent zero value
+				}
+				rcv[rx].demodfreq = temp ;											// offset detected by the demodulator
+                if (rcv[rx].scanstate == STATE_DEMOD_S2 || rcv[rx].scanstate  == STATE_DEMOD_S) 
+                {
+					if (rcv[rx].qo100mode == QO100BEACON)							// update loc error
+					{
+						tempu 					   = ((rx - 1) & 2) + 1  ;			// 1,2,3,4 --> 1,1,3,3
+						rcv[tempu].qo100locerror   = -temp ;						// first receiver
+						rcv[tempu+1].qo100locerror = -temp ;						// second receiver
+					}                
+                	if (rcv[rx].signalacquiredtime == 0)
+	                {
+						if (rcv[rx].vlcstopped == 0)
+						{
+							memset ((void*)&rcv[rx].rawinfos,0,sizeof(rcv[rx].rawinfos)) ;
+							memset ((void*)&rcv[rx].textinfos,0,sizeof(rcv[rx].textinfos)) ;			
+							psi_cache_clear (rx) ;										// parse the PSI tables again
+							__atomic_fetch_add (&rcv[rx].pidtablechanges, 1, __ATOMIC_RELEASE) ;
+							rcv[rx].vlcstopped = 1 ;
+							rcv[rx].vlcstopcount++ ;
+							rcv[rx].rawinfos[STATUS_VLCSTOPS] = rcv[rx].vlcstopcount ;
+							if (rcv[rx].xdotoolid)
+							{
+								vlc_key (rx, 's', 0) ;						// send STOP to VLC
+							}
+						}               
+						rcv[rx].signalacquiredtime = monotime_ms() ;				// signal first acquired
+						rcv[rx].rawinfos[STATUS_TUNE_TO_LOCK] = rcv[rx].tunetolock ;
+						rcv[rx].signallosttime    = 0 ;								// clear the lost time
+						rcv[rx].packetcountrx = 0 ;									// clear null packet count
+						rcv[rx].nullpacketcountrx = 0 ;								// clear null packet count
+						y = STATUS_VIDEO_TYPE ;
+						rcv[rx].rawinfos[y]    	  = 0 ;								// clear the service type
+						rcv[rx].textinfos[y][0]	  = 0 ;								
+        	        }
+        		}        
+
+                y = STATUS_CARRIER_FREQUENCY ;                                      // parameter 6 - frequency
+            	rcv[rx].rawinfos[y]      =  rcv[rx].requestedfreq  ;
+				if (rcv[rx].qo100mode   != QO100BEACON)
+				{
+					if (rcv[rx].highsideloc == 0)		
+					{
+						rcv[rx].rawinfos[y] += rcv[rx].demodfreq ;					// adjust the actual frequency
+					}
+					else
+					{
+						rcv[rx].rawinfos[y] -= rcv[rx].demodfreq ;
+					}
+				}
+
+                y = STATUS_CARRIER_FREQUENCY ;                                      // parameter 6 - frequency
+                sprintf (rcv[rx].textinfos[y], "%0.3f" ,(float)rcv[rx].rawinfos[y] / 1000) ;  	// frequency in MHz    
+
+                y = STATUS_SYMBOL_RATE ;                                            // parameter 9
+                tempu = rcv[rx].telemetry.symbolrate ;                      		// the symbol rate               
+                rcv[rx].rawinfos[y] = tempu ;
+                sprintf (rcv[rx].textinfos[y], "%d" ,(tempu + 500) / 1000) ;    	// symbol rate in kS  
+                
+                y = STATUS_MER ;                                                    // parameter 12  
+                temp = rcv[rx].telemetry.mer ;                      				// the MER in 0.1dB units               
+                rcv[rx].rawinfos[y] = temp ;										
+                if (temp > 999)
+                {
+					temp = 999 ;
+                }
+                else if (temp < -999)
+                {
+					temp = -999 ;
+                }
+                sprintf (rcv[rx].textinfos[y], "%.1f" ,((float) temp) / 10) ;		// MER  
+
+           	    if (rcv[rx].scanstate == STATE_HEADER_S2 || rcv[rx].scanstate == STATE_DEMOD_S2) // DVB-S2 header or lock
+                {                    
+                    y = STATUS_MODCOD ;                                    			// parameter 18
+                    tempu = rcv[rx].telemetry.modcod ;									// modcod, frametype, pilots
+                    bool1 = rcv[rx].telemetry.shortframe ;
+                    bool2 = rcv[rx].telemetry.pilots ;
+					if (tempu == rcv[rx].lastmodulation)							// check for consecutive similar
+					{
+	                    rcv[rx].rawinfos[y] = tempu ;
+    	                sprintf (rcv[rx].textinfos[y], "%s" , modinfo_S2[tempu].modtext) ; 			// qpsk 3/4 etc 
+	                    y = STATUS_DNUMBER ; 														// decode threshold
+						temp = rcv[rx].rawinfos[STATUS_MER] - modinfo_S2[tempu].minmer ;
+	                    rcv[rx].rawinfos[y] = temp ; 
+    	                sprintf (rcv[rx].textinfos[y], "%.1f" , (float) temp / 10) ;
+
+	                    y = STATUS_FRAME_TYPE ;                                         			// parameter 19
+    	                rcv[rx].rawinfos[y] = (bool1 ? 1 : 0) ;
+						if (rcv[rx].rawinfos[y])
+						{	
+							sprintf (rcv[rx].textinfos[y], "S") ;
+						}
+						else
+						{	
+							sprintf (rcv[rx].textinfos[y], "L") ;
+						}
+	
+    	                y = STATUS_PILOTS ;                                             			// parameter 20
+	                    rcv[rx].rawinfos[y] = (bool2 ? 1 : 0) ;                                    
+						if (rcv[rx].rawinfos[y])
+						{	
+							sprintf (rcv[rx].textinfos[y], "Y") ;
+						}
+						else
+						{	
+							sprintf (rcv[rx].textinfos[y], "N") ;
+						}
+	
+						y = STATUS_ROLLOFF ;
+	    	            tempu = rcv[rx].telemetry.rolloff ; 		                				// the rolloff               
+						rcv[rx].rawinfos[y] = tempu ;
+						switch (rcv[rx].rawinfos[y])
+						{
+							case 0 : sprintf (rcv[rx].textinfos[y],"35") ; break ;
+							case 1 : sprintf (rcv[rx].textinfos[y],"25") ; break ;
+							case 2 : sprintf (rcv[rx].textinfos[y],"20") ; break ;
+							case 3 : sprintf (rcv[rx].textinfos[y],"15") ; break ;
+						} ;
+					}
+					else
+					{
+						rcv[rx].lastmodulation = tempu ;
+					}
+
+                }
+                else if (rcv[rx].scanstate == STATE_DEMOD_S)									// DVB-S
+                {
+                    y = STATUS_MODCOD ;                                             			// parameter 18
+					tempc = rcv[rx].telemetry.puncture ;
+					rcv[rx].rawinfos[y] = 100 + tempc ;
+					sprintf (rcv[rx].textinfos[y], "%s", modinfo_S[tempc].modtext) ;
+
+					if (tempc == rcv[rx].lastmodulation)							// check for consecutive similar
+					{
+	                    y = STATUS_DNUMBER ; 														// decode threshold
+						temp = rcv[rx].rawinfos[STATUS_MER] - modinfo_S[tempc].minmer ;
+                    	rcv[rx].rawinfos[y] = temp ; 
+                    	sprintf (rcv[rx].textinfos[y], "%.1f" , (float) temp / 10) ;
+                    }
+					else
+					{
+						rcv[rx].lastmodulation = tempc ;
+					}
+                }
+                else 																			// set some parameters to default
+                {
+/*                
+	                y = STATUS_MODCOD ;                                         				// parameter 18
+                    rcv[rx].rawinfos[y] = 0 ;
+       	            sprintf (rcv[rx].textinfos[y],"%s","") ;                               
+                
+	                y = STATUS_FRAME_TYPE ;                                     				// parameter 19
+                    rcv[rx].rawinfos[y] = 0 ;
        	            sprintf (rcv[rx].textinfos[y],"%s","") ;                               
                 
            	        y = STATUS_PILOTS ;                                         				// parameter 20
@@ -2628,829 +4312,2829 @@ static	uint32			counter ;
                     rcv[rx].rawinfos[y] = rcv[rx].symbolrates[rcv[rx].srindex] ;
                     sprintf (rcv[rx].textinfos[y],"%d",rcv[rx].rawinfos[y]) ;                              
 
-	                y = STATUS_CARRIER_FREQUENCY ;                                  			// parameter 6 - frequency
-					temp = rcv[rx].frequencies[rcv[rx].freqindex] ;
-        	        rcv[rx].rawinfos[y] = temp ;
-            	    sprintf (rcv[rx].textinfos[y], "%.3f" ,((float)temp) / 1000) ;   			// frequency in MHz    
-                }
-                
-// put info into VLC header bar
+	                y = STATUS_CARRIER_FREQUENCY ;                                  			// parameter 6 - frequency
+					temp = rcv[rx].frequencies[rcv[rx].freqindex] ;
+        	        rcv[rx].rawinfos[y] = temp ;
+            	    sprintf (rcv[rx].textinfos[y], "%.3f" ,((float)temp) / 1000) ;   			// frequency in MHz    
+                }
+                
+// put info into VLC header bar
+
+				setup_titlebar (titlebar, rx) ;										// create the VLC title bar
+
+				if (rcv[rx].xdotoolid)
+				{				
+					if ((modex != MODE_MULTICAST) && (rcv[rx].iptype != IP_MYPC))
+					{
+						sprintf (titlebar, "%d: *TS diverted to another location*", rx) ;
+					}			
+					else
+					{
+						setup_titlebar (titlebar, rx) ;								// create the VLC title bar
+					}
+					vlc_title (rx, titlebar) ;										// sent only if it has changed
+				}
+
+				setup_titlebar (titlebar, rx) ;										// create the VLC title bar
+				strcpy (rcv[rx].textinfos[STATUS_TITLEBAR], titlebar) ;				
+
+
+// send a modified EIT packet to be displayed in the VLC title bar
+
+				if (eitinsert && rcv[rx].iptype != IP_MYPC)															// this function is enabled
+				{
+					if ((counter & 1) == 0)
+					{
+						if ((counter & 3) == 0)
+						{
+							rcv[rx].eitversion++ ;
+						}	
+						setup_eit ((void*)&command, rx, titlebar) ;
+						if 
+						(
+							(rcv[rx].scanstate != STATE_TIMEOUT && rcv[rx].scanstate != STATE_IDLE) || 
+							rcv[rx].timeoutholdoffcount != 0
+						)
+						{
+		                    status = sendto
+    		                (
+	    		            	rcv[rx].tssock, (char*)&command, 188, 0,
+	            	            (struct sockaddr*) &rcv[rx].tssockaddr, sizeof(rcv[rx].tssockaddr)
+    	            	    ) ;
+        	            	(void) status ;                                                      
+            	        }
+            	    }
+				}
+            } 
+
+            if (rcv[rx].active == 0)
+            {
+               	strcpy (temps2, "") ;
+            }
+            else
+            {
+				if (rcv[rx].packetcountrx < 10000000)
+				{
+					sprintf (temps2,"%7d", rcv[rx].packetcountrx) ;
+				}
+				else
+				{
+					sprintf (temps2, 	 "%-.6fM", (float) rcv[rx].packetcountrx / 1000000) ;	
+					if (strlen(temps2) > 7)
+					{
+						sprintf (temps2 + 6, "M") ;	
+					}
+				}
+			}
+
+			strncpy (temps3, rcv[rx].textinfos[STATUS_SERVICE_NAME], sizeof(temps3)-1) ;
+		    temps3 [15] = 0 ;
+
+			y = STATUS_TS_NULL_PERCENTAGE ;
+			sprintf 
+			(
+				rcv[rx].textinfos[y], 
+				"%0.1f", 
+				(float) 99.9 * rcv[rx].nullpacketcountrx / (rcv[rx].packetcountrx + 1)
+			) ;
+			rcv[rx].rawinfos[y] = atof (rcv[rx].textinfos[y]) + 0.5 ; 			
+	
+			sprintf 
+			(
+				temps,
+				"%1s%1s%2s",									
+				rcv[rx].textinfos[STATUS_FRAME_TYPE], 
+				rcv[rx].textinfos[STATUS_PILOTS], 
+				rcv[rx].textinfos[STATUS_ROLLOFF]
+			) ;
+
+// start building the info line for this rx
+		     
+	       	sprintf 
+       		(
+       			output + strlen(output),
+               	" %2d  %-7s  %-15s  %5s  %5s  %9s  %5s  %-11s  ",  
+   	            rx + rxbase, 
+       			rcv[rx].textinfos [STATUS_STATE], 	
+				temps3,						       				// rcv[rx].textinfos[STATUS_SERVICE_NAME]
+       			rcv[rx].textinfos [STATUS_MER],
+  				rcv[rx].textinfos [STATUS_DNUMBER],
+      			rcv[rx].textinfos [STATUS_CARRIER_FREQUENCY],	
+       			rcv[rx].textinfos [STATUS_SYMBOL_RATE],
+      			rcv[rx].textinfos [STATUS_MODCOD]
+			) ;
+
+			sprintf (temps3, "%s-%s", rcv[rx].textinfos[STATUS_VIDEO_TYPE],rcv[rx].textinfos [STATUS_AUDIO_TYPE]) ;
+			if (strlen(temps3) == 1)
+			{	
+				strcpy (temps3, "") ;
+			}
+
+	       	sprintf 
+       		(
+       			output + strlen(output),
+               	"%-4s  %-8s  %3s  %7s  %4s  %-8s  ",    						
+				temps,											// FPRO
+				temps3,											// video-audio	
+      			rcv[rx].textinfos [STATUS_ANTENNA],
+				temps2,											// packetcount
+      			rcv[rx].textinfos [STATUS_TS_NULL_PERCENTAGE],
+                rcv[rx].nimtype
+       		) ;
+
+			strcat  (outputonnet, output) ;						// add the output line 			
+			sprintf (outputonnet+strlen(outputonnet), "%-15s", rcv[rx].ipaddress) ;	// TS destination
+	       	sprintf (outputonnet+strlen(outputonnet), "\r\n") ;			
+
+			strcat  (outputoffnet, output) ;					// add the output line 			
+			tempu = inet_addr (rcv[rx].ipaddress) ;				// convert to numeric
+			tempu &= 0xffff ;									// mask off the 2 lower numbers
+			sia.s_addr = tempu ;
+			sprintf (outputoffnet+strlen(outputoffnet), "%-15s", inet_ntoa(sia)) ;	// masked TS destination
+	       	sprintf (outputoffnet+strlen(outputoffnet), "\r\n") ;			
+
+// end of the loop for each receiver
+
+// build the original LM $ text info for an individual receiver
+     
+        	sprintf (temps, "%s", "") ;
+			for (y = 1 ; y <= STATUS_LNB_POLARISATION_H ; y++)
+			{
+				if (rcv[rx].textinfos[y][0])
+				{
+					if (y == STATUS_SERVICE_NAME || y == STATUS_SERVICE_PROVIDER_NAME)
+					{
+						sprintf (temps+strlen(temps), "$%d,%s\r\n", y, rcv[rx].textinfos[y]) ;
+					}
+					else				
+					{
+						sprintf (temps+strlen(temps), "$%d,%d\r\n", y, rcv[rx].rawinfos[y]) ;
+					}
+				}
+			}
+
+// send the orginal LM $ text info for this receiver
+
+			if 
+			(
+				(rcv[rx].scanstate != STATE_TIMEOUT && rcv[rx].scanstate != STATE_IDLE) || 
+				rcv[rx].timeoutholdoffcount != 0
+			)
+			{
+				if (rcv[rx].lminfosock)						// valid socket
+				{
+			        status = sendto 						// send to base port + 60 + receiver (1-4)
+    			  	(
+   	    			   	rcv[rx].lminfosock, (char*)temps, strlen(temps) + 1, 0,
+	    	   			(struct sockaddr*) &rcv[rx].lminfosockaddr, sizeof(rcv[rx].lminfosockaddr) 
+					) ;
+   					(void) status ;
+				}
+			}
+		}
+		
+// end of the 4 receiver loop
+
+		for (rx = 1 ; rx <= 4 ; rx++)
+		{
+			if (rcv[rx].active == 0)
+			{
+				sprintf (outputonnet+strlen(outputonnet), "\r\n") ;
+				sprintf (outputoffnet+strlen(outputoffnet), "\r\n") ;
+			}
+		}		
+
+		printf ("%c[6A",ESC) ;						// UP cursor tp prevent scrolling
+   	   	printf ("%s", outputonnet) ;
+
+// system statistics, sent as the expanded info for receiver 0
+
+		y = STATUS_TS_READ_PACKETS ;
+		tempu = tsreadcount - lastreadcount ;
+		rcv[0].rawinfos[y] = 0 ;
+		if (tempu)
+		{
+			rcv[0].rawinfos[y] = (tsreadpackets - lastreadpackets + tempu / 2) / tempu ;
+		}
+		sprintf (rcv[0].textinfos[y], "%d", rcv[0].rawinfos[y]) ;
+		lastreadcount   = tsreadcount ;
+		lastreadpackets = tsreadpackets ;
+
+		y = STATUS_RING_OVERRUNS ;									// only known when the rings are mapped
+		rcv[0].rawinfos[y] = 0 ;
+		rcv[0].textinfos[y][0] = 0 ;
+		if (whctl)
+		{
+			rcv[0].rawinfos[y] = whctl->overrunsA + whctl->overrunsB ;
+			sprintf (rcv[0].textinfos[y], "%u/%u", whctl->overrunsA, whctl->overrunsB) ;
+		}
+
+		y = STATUS_I2C_ACCESSES ;
+		tempu = i2caccesses - lasti2caccesses ;
+		rcv[0].rawinfos[y] = tempu ;
+		sprintf (rcv[0].textinfos[y], "%d", rcv[0].rawinfos[y]) ;
+		y = STATUS_I2C_TIME ;
+		rcv[0].rawinfos[y] = 0 ;
+		if (tempu)
+		{
+			rcv[0].rawinfos[y] = (i2caccesstime - lasti2caccesstime) / tempu ;
+		}
+		sprintf (rcv[0].textinfos[y], "%d", rcv[0].rawinfos[y]) ;
+		lasti2caccesses   = i2caccesses ;
+		lasti2caccesstime = i2caccesstime ;
+
+		for (x = 0 ; x < I2CCLASSES ; x++)							// I2C bus queueing delay by class
+		{
+			y = x == I2CTUNE ? STATUS_I2C_WAIT_TUNE : STATUS_I2C_WAIT_INFO ;
+			tempu = i2cwaits [x] - lasti2cwaits [x] ;
+			rcv[0].rawinfos[y] = 0 ;
+			if (tempu)
+			{
+				rcv[0].rawinfos[y] = (i2cwaittime [x] - lasti2cwaittime [x]) / tempu ;
+			}
+			sprintf (rcv[0].textinfos[y], "%d", rcv[0].rawinfos[y]) ;
+			lasti2cwaits    [x] = i2cwaits    [x] ;
+			lasti2cwaittime [x] = i2cwaittime [x] ;
+		}
+
+// send info
+
+		for (rx = 0 ; rx <= MAXRECEIVERS ; rx++)
+		{
+			if (1)
+			{
+				if 
+				(
+					rx == 0 ||
+					(rcv[rx].scanstate != STATE_TIMEOUT && rcv[rx].scanstate != STATE_IDLE) || 
+					rcv[rx].timeoutholdoffcount != 0		// send info a few times after timeout
+				)
+				{
+
+					if (rcv[rx].antenna == 1)
+					{
+						sprintf (rcv[rx].textinfos[STATUS_ANTENNA], "TOP") ;
+					}
+					else if (rcv[rx].antenna == 2)
+					{
+						sprintf (rcv[rx].textinfos[STATUS_ANTENNA], "BOT") ;
+					}
+							
+// send expanded LM $ text info 
+			     
+			   		strcpy (temps, "") ;									// expanded LM info
+		        	sprintf (temps+strlen(temps),"$0,%d\r\n", rx + rxbase) ;
+					sprintf (rcv[rx].textinfos[STATUS_VLCSTOPS], "%d", rcv[rx].vlcstopcount) ;
+					sprintf (rcv[rx].textinfos[STATUS_VLCNEXTS], "%d", rcv[rx].vlcnextcount) ;
+					for (y = 1 ; y < MAXINFOS ; y++)
+					{
+						if (rcv[rx].textinfos[y][0])
+						{
+							sprintf (temps+strlen(temps), "$%d,%s\r\n", y, rcv[rx].textinfos[y]) ;
+						}
+					}
+				
+					if (rcv[rx].expinfosock)		// valid socket
+					{
+	    			    status = sendto 						
+   						(
+			    	   		rcv[rx].expinfosock, (char*)temps, strlen(temps) + 1, 0,
+  							(struct sockaddr*) &rcv[rx].expinfosockaddr, sizeof(rcv[rx].expinfosockaddr) 
+						) ;
+					}
+					if (rcv[rx].expinfo2sock)		// valid socket
+					{
+	    			    status = sendto 			// duplicate to next port
+	    	  			(
+  					   		rcv[rx].expinfo2sock, (char*)temps, strlen(temps) + 1, 0,
+	   			   			(struct sockaddr*) &rcv[rx].expinfo2sockaddr, sizeof(rcv[rx].expinfo2sockaddr) 
+						) ;
+		  				(void) status ;
+					}
+					temp = 0 ;
+					for (y = 0 ; y < rx ; y++)				// check if already sent to this address
+					{
+						if 
+						(
+							(rcv[y].scanstate != STATE_TIMEOUT && rcv[y].scanstate != STATE_IDLE) || 
+							rcv[y].timeoutholdoffcount != 0
+						)
+						{
+							if (strcmp(rcv[y].ipaddress,rcv[rx].ipaddress) == 0)
+							{
+								temp++ ;						// already sent to this address
+							}						
+						}
+					}
+					
+// send 4 line info
+
+   					if ((rx == 0) || (temp == 0))				// haven't already sent to this address
+					{
+						if (rcv[rx].iptype == IP_OFFNET)		// mask TS destinations for off net
+						{
+							if (rcv[rx].summarysock)			// valid socket
+							{
+			    			    status = sendto 						
+			   		  			(
+				    	   			rcv[rx].summarysock, (char*)outputoffnet, strlen(outputoffnet) + 1, 0,
+	   					   			(struct sockaddr*) &rcv[rx].summarysockaddr, sizeof(rcv[rx].summarysockaddr) 
+								) ;
+   								(void) status ;
+							}
+							if (rcv[rx].summary2sock)			// valid socket
+							{
+			    			    status = sendto 						
+			   		  			(
+				    	   			rcv[rx].summary2sock, (char*)outputoffnet, strlen(outputoffnet) + 1, 0,
+	   					   			(struct sockaddr*) &rcv[rx].summary2sockaddr, sizeof(rcv[rx].summary2sockaddr) 
+								) ;
+   								(void) status ;
+							}
+						}
+						else									// on net
+						{
+							if (rcv[rx].summarysock)			// valid socket
+							{
+			    			    status = sendto 						
+			   		  			(
+				    	   			rcv[rx].summarysock, (char*)outputonnet, strlen(outputonnet) + 1, 0,
+	   					   			(struct sockaddr*) &rcv[rx].summarysockaddr, sizeof(rcv[rx].summarysockaddr) 
+								) ;
+   								(void) status ;
+							}
+							if (rcv[rx].summary2sock)			// valid socket
+							{
+			    			    status = sendto 						
+			   		  			(
+				    	   			rcv[rx].summary2sock, (char*)outputonnet, strlen(outputonnet) + 1, 0,
+	   					   			(struct sockaddr*) &rcv[rx].summary2sockaddr, sizeof(rcv[rx].summary2sockaddr) 
+								) ;
+   								(void) status ;
+							}
+						}
+					}
+  				}				
+   			}
+   			if (rcv[rx].timeoutholdoffcount)
+   			{
+	   			rcv[rx].timeoutholdoffcount-- ;		// decrement the holdoff count
+   			}
+		}		
+	}
+
+	printf ("INFO   thread exiting\r\n") ;
+	return (0) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 tsproc
+//@
+//@	 a thread to process incoming packets and send them via UDP
+//@	 packets are processed in place in the driver's rings if they are mapped,
+//@	 otherwise each read from the driver returns up to TSREADPACKETS packets
+//@
+//@	 Calling:	
+//@
+//@	 Return:	
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void* tsproc_loop (void* dummy)
+{
+		uint32		n ;
+		uint32		packets ;
+		uint32		waitms ;
+		int32		status ;
+static	uint8		rxbuff [TSREADPACKETS * 192] ;
+
+	(void) dummy ;
+
+	while (tsprocenabled == 0) 
+	{
+		usleep (100*1000) ;
+	}
+
+	while (tsprocenabled == 1)
+	{
+			waitms = tsout_flush () ;						// send the TS from the last wakeup
+
+			if (whctl)										// the packet rings are mapped
+			{
+				packets = tsproc_rings (waitms) ;
+				if (packets)
+				{
+					tsreadcount++ ;
+					tsreadpackets += packets ;
+				}
+				continue ;
+			}
+
+			status = read (whfd, (void*)rxbuff, sizeof(rxbuff)) ;
+			if ((status > 0) && ((status % 192) == 0))		// one or more packets received
+			{
+				packets = status / 192 ;
+			}
+			else if ((status == -1) && (errno == 3))		// kernel driver is unloading
+			{
+				packets = 0 ;
+				printf ("<<Exiting %d>>\r\n",status) ;
+				usleep (5 * 1000 * 1000) ;
+				whexit (999) ;
+			}
+			else if ((status == -1) && (errno == 4))
+			{
+				packets = 0 ;
+				printf ("<<Driver does not have spi5interruptnumber>>\r\n") ;
+				usleep (5 * 1000 * 1000) ;
+				whexit (986) ;
+			}
+			else if ((status == -1) && (errno == 5))
+			{
+				packets = 0 ;								// read timeout - normal behaviour
+			}
+			else if (status < 0)
+			{
+				printf ("[<%d %d>]\r\n",status,errno) ;
+				packets = 0 ;
+				continue ;
+			}
+			else
+			{
+				packets = 0 ;
+			}
+
+			if (packets == 0)
+			{
+				continue ;
+			}
+
+			tsreadcount++ ;
+			tsreadpackets += packets ;
+
+			for (n = 0 ; n < packets ; n++)
+			{
+				tsproc_packet ((packetx_t*) &rxbuff [n * 192]) ;
+			}
+	}
+
+	printf ("TSPROC thread exiting\r\n") ;
+	return (0) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 tsproc_rings
+//@
+//@	 wait for packets in the driver's mapped rings and process them in place
+//@	 PIC_B and PIC_A packets are taken alternately, as the driver does for read()
+//@
+//@	 Calling:	maximum time to wait for a packet (ms)
+//@
+//@	 Return:	number of packets processed
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+    	
+uint32 tsproc_rings (uint32 waitms)
+{
+		struct pollfd	pfd ;
+		int32			status ;
+
+	pfd.fd      = whfd ;
+	pfd.events  = POLLIN ;
+	pfd.revents = 0 ;
+	status = poll (&pfd, 1, waitms) ;
+	if (status == 0)
+	{
+		return (0) ;												// timeout - normal behaviour
+	}
+	else if (status < 0)
+	{
+		if (errno != EINTR)
+		{
+			printf ("[<%d %d>]\r\n",status,errno) ;
+		}
+		return (0) ;
+	}
+	else if (pfd.revents & POLLHUP)									// kernel driver is closing
+	{
+		printf ("<<Exiting %d>>\r\n",status) ;
+		usleep (5 * 1000 * 1000) ;
+		whexit (999) ;
+	}
+	else if (pfd.revents & POLLERR)
+	{
+		printf ("<<Driver does not have spi5interruptnumber>>\r\n") ;
+		usleep (5 * 1000 * 1000) ;
+		whexit (986) ;
+	}
+
+	return (tsproc_drain ()) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 tsproc_drain
+//@
+//@	 process all the packets waiting in the rings, PIC_B and PIC_A alternately
+//@	 also used by the whreplay program, with rings that it fills itself
+//@
+//@	 Calling:
+//@
+//@	 Return:	number of packets processed
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+uint32 tsproc_drain (void)
+{
+		uint32			packets ;
+		uint32			more ;
+
+	packets = 0 ;
+	do
+	{
+		more = 0 ;
+		if (whring_count (whctl->readyB, whctl->fetchedB))
+		{
+			__sync_synchronize () ;									// read the packet after its count
+			tsproc_packet ((packetx_t*) whring_packet (whrings + WHRING_RINGSIZE, whctl->fetchedB)) ;
+			__atomic_store_n (&whctl->fetchedB, whctl->fetchedB + 1, __ATOMIC_RELEASE) ;	// the slot may now be reused
+			more++ ;
+		}
+		if (whring_count (whctl->readyA, whctl->fetchedA))
+		{
+			__sync_synchronize () ;
+			tsproc_packet ((packetx_t*) whring_packet (whrings, whctl->fetchedA)) ;
+			__atomic_store_n (&whctl->fetchedA, whctl->fetchedA + 1, __ATOMIC_RELEASE) ;	// the slot may now be reused
+			more++ ;
+		}
+		packets += more ;
+	}
+	while (more) ;
+
+	return (packets) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 tsproc_packet
+//@
+//@	 process one packet from the driver and send it via UDP
+//@
+//@	 Calling:	pp		packet followed by its PIC status word
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void tsproc_packet (packetx_t* pp)
+{
+		int			x ;
+		uint8		tempc ;
+		uint32		tempu ;
+		uint32		rx ;
+		uint16		pid ;
+		uint8		action ;
+
+	rx = pp->receiver + 1 ;										// receivers are numbered 0-3 in the PICs						
+																// . . . and 1 to 4 in this program	
+	if ((rcv[rx].active == 0) || (rcv[rx].tsgate == 0))			// opened by the I2C thread on lock
+	{
+	}
+	else if (pp->data[0] != 0x47)								// sync byte missing
+	{
+		rcv[rx].errors_sync++ ;		       						
+		rcv[rx].packetcountprogram++ ;							
+		rcv[rx].packetcountrx++ ;				
+		return ;
+	}
+	else if (pp->valid)
+	{				
+		tempc = (pp->receiver & 2) + 1 ;						// rx1, rx3 <==> PIC_A or PIC_B 			
+		rcv[tempc].debug0 = pp->crc8 ;
+
+		tempu = pp->outsequence - rcv[tempc].outsequence ;		// 4 bit output sequence for each PIC
+		tempu &= 0xf ;
+		if (tempu != 1)
+		{
+			rcv[tempc].errors_outsequence ++ ;		       	
+			rcv[tempc].outsequence = pp->outsequence ;		       	
+		}
+		else
+		{
+			rcv[tempc].outsequence++ ;		       						
+		}
+		
+		tempu = pp->insequence - rcv[rx].insequence ;			// 4 bit input sequence for each receiver
+		tempu &= 0xf ;
+		if (tempu != 1)
+		{
+			rcv[rx].errors_insequence++ ;		       	
+			rcv[rx].insequence = pp->insequence ;
+		}
+		else
+		{
+			rcv[rx].insequence++ ;
+		}
+
+		if (pp->restart)
+		{
+			rcv[rx].errors_restart++ ;
+		}
+		
+		pid = (pp->data[1] & 0x1f) * 0x100 + pp->data[2] ;
+		if (rcv[rx].psiclearsdone != __atomic_load_n (&rcv[rx].psiclears, __ATOMIC_ACQUIRE))
+		{
+			psi_cache_reset (rx) ;								// a new reception has started
+		}
+		if (rcv[rx].pidtablebuilt != __atomic_load_n (&rcv[rx].pidtablechanges, __ATOMIC_ACQUIRE))
+		{
+			pid_table_build (rx) ;								// configuration or PSI has changed
+		}
+		action = rcv[rx].pidactions [pid] ;
+		
+		rcv[rx].packetcountprogram++ ;				
+		rcv[rx].packetcountrx++ ;				
+		rcv[rx].packetcountprogram 		+= pp->nullpackets ;				
+		rcv[rx].packetcountrx      		+= pp->nullpackets ;				
+		rcv[rx].nullpacketcountprogram  += pp->nullpackets ;				
+		rcv[rx].nullpacketcountrx       += pp->nullpackets ;				
+		if (action & PID_NULL)
+		{
+			rcv[rx].nullpacketcountprogram++ ;				
+			rcv[rx].nullpacketcountrx++ ;				
+		}
+
+	  	if (rcv[rx].tsgate)
+	  	{	
+	  		if (rcv[rx].tssock)
+	  		{
+				if (nullremove == 0)
+				{
+					if (rcv[rx].vlcstopped == 0)
+					{
+						for (x = 0 ; x < pp->nullpackets ; x++)
+						{
+							tsout_packet (rx, (uint8*)nullpacket) ;			// restore the nulls removed by the PIC
+						}
+					}
+				}						
+				
+				if (action & PID_SEND)
+				{
+					if (rcv[rx].vlcstopped == 0)
+					{
+						tsout_packet (rx, pp->data) ;
+						if (rcv[rx].packetpending)						// first packet since the tune locked
+						{
+							rcv[rx].packetpending = 0 ;
+							rcv[rx].tunetopacket  = monotime_ms() - rcv[rx].tunerequesttime ;
+						}
+					}
+				}
+			
+// PSI sections are assembled and parsed by psi_packet
+
+				if (action & PID_PAT)
+				{
+					psi_packet (rx, PSI_PAT, pp->data) ;
+				}
+				else if (action & PID_PMT)								// the program we want
+				{	
+					psi_packet (rx, PSI_PMT, pp->data) ;
+				}
+				else if (action & PID_SDT)								// service descriptor
+				{
+					psi_packet (rx, PSI_SDT, pp->data) ;
+				}				
+    	}		    	   
+		} 
+	}
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 pid_table_build
+//@
+//@	 rebuild the action for each PID of a receiver after the configuration or PSI has changed
+//@	 a PID is sent unless:
+//@		the TS may not be sent to VLC on this PC (H.265 decoder limit)
+//@		there is a user whitelist and the PID is not on it, or the PAT or PMT
+//@		the PID is on the user blacklist
+//@		it is EIT or null and is being removed
+//@
+//@	 Calling:	rx			receiver number
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void pid_table_build (uint32 rx)
+{
+		uint32		pid ;
+		uint32		send ;
+		uint32		pmtpid ;
+		uint32		y ;
+		uint8*		actions ;
+
+	rcv[rx].pidtablebuilt = __atomic_load_n (&rcv[rx].pidtablechanges, __ATOMIC_ACQUIRE) ;
+	actions = rcv[rx].pidactions ;
+	pmtpid  = rcv[rx].pmtpid ;
+
+	y = STATUS_VIDEO_TYPE ;
+	if 
+	(									
+		(rx == 1) 								|| 
+		(rx <= h265max + 1) 					|| 
+		(modex == MODE_MULTICAST) 				||
+		(rcv[rx].iptype != IP_MYPC)				||
+		(rcv[rx].rawinfos[y] == SERVICE_H262) 	||
+		(rcv[rx].rawinfos[y] == SERVICE_H264)
+	)
+	{
+		send = PID_SEND ;
+		rcv[rx].forbidden = 0 ;
+	}
+	else
+	{
+		send = 0 ;												// don't send
+		rcv[rx].forbidden = rcv[rx].rawinfos[y] ? 1 : 0 ;
+	}
+
+	for (pid = 0 ; pid < NUMPIDS ; pid++)
+	{
+		actions [pid] = send ;
+		if (rcv[rx].pidpasscount && pid != PAT_PID && pid != pmtpid)
+		{
+			if (((rcv[rx].pidpass [pid >> 5] >> (pid & 31)) & 1) == 0)
+			{
+				actions [pid] = 0 ;								// not on the whitelist
+			}
+		}
+		if ((rcv[rx].pidblock [pid >> 5] >> (pid & 31)) & 1)
+		{
+			actions [pid] = 0 ;									// on the blacklist
+		}
+	}
+
+	if (eitremove)
+	{
+		actions [EIT_PID] &= ~PID_SEND ;						// remove from the incoming TS
+	}
+	actions [NULL_PID] |= PID_NULL ;
+	if (nullremove)
+	{
+		actions [NULL_PID] &= ~PID_SEND ;						// don't send null packets
+	}
+	if (null8190)
+	{
+		actions [NULL2_PID] |= PID_NULL ;						// fake null packet
+		if (nullremove)
+		{
+			actions [NULL2_PID] &= ~PID_SEND ;
+		}
+	}
+
+	actions [PAT_PID] |= PID_PAT ;
+	if (pmtpid)
+	{
+		actions [pmtpid]  |= PID_PMT ;
+	}
+	actions [SDT_PID] |= PID_SDT ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 command_parse
+//@
+//@	 split a command into its items in one pass and collect the settings
+//@	 items are KEY=value, separated by commas; list values such as FREQ= contain commas too
+//@	 a [to@wh] command on the common port may set up several receivers: each RCV= after
+//@	 the first starts the settings for the next receiver
+//@	 e.g. [to@wh],rcv=1,freq=10491500,...,rcv=2,freq=10492750,...
+//@	 the voltage and tone settings are global and are made as they are found
+//@
+//@	 Calling:	text		upper case command with non printing characters removed
+//@				port		the receiver whose port it arrived on; 0 for the common port
+//@				cmds		MAXRECEIVERS entries for the settings
+//@
+//@	 Return:	number of receivers in the command
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+uint32 command_parse (char* text, uint32 port, struct command* cmds)
+{
+		char*			pos ;
+		char*			key ;
+		char*			value ;
+		uint32			count ;
+		uint32			n ;
+		uint32			towh ;
+		uint32			qt ;
+		uint32			survey ;
+		uint32			overflow ;
+		uint32			rcvgiven [MAXRECEIVERS] ;
+		struct command*	cmd ;
+
+	count 		= 1 ;
+	cmd   		= &cmds [0] ;
+	command_clear (cmd) ;
+	rcvgiven[0] = 0 ;
+	towh  		= 0 ;
+	qt    		= 0 ;
+	survey 		= 0 ;
+	overflow 	= 0 ;
+
+	pos = text ;
+	while (*pos)
+	{
+		while (*pos == ' ')
+		{
+			pos++ ;
+		}
+		key = pos ;
+		if (*pos == '[')
+		{
+			if (strncmp (pos, "[TO@WH]", 7) == 0)
+			{
+				towh = 1 ;
+			}
+			else if (pos == text && strncmp (pos, "[GLOBALMSG]", 11) == 0)		// QuickTune command
+			{
+				qt = 1 ;
+			}
+		}
+		else
+		{
+			while (isalnum (*pos))
+			{
+				pos++ ;
+			}
+			value = pos + 1 ;
+			if (*pos != '=')
+			{
+				if (command_word (key, "SURVEY"))									// band survey
+				{
+					survey = 1 ;
+				}
+			}
+			else if (command_word (key, "RCV"))
+			{
+				if (rcvgiven [count - 1])											// the next receiver of a batch
+				{
+					if (count < MAXRECEIVERS)
+					{
+						cmd = &cmds [count] ;
+						command_clear (cmd) ;
+						rcvgiven [count] = 0 ;
+						count++ ;
+					}
+					else
+					{
+						overflow = 1 ;
+					}
+				}
+				rcvgiven [count - 1] = 1 ;
+				cmd->rx = atoi (value) ;
+			}
+			else if (command_word (key, "FREQ"))
+			{
+				cmd->freq 		= atoi (value) ;
+				cmd->freqcount 	= scan_list_parse (value, cmd->freqlist, MAXFREQSTOSCAN) ;	// FREQ=f1,f2,.. or FREQ=first-last/step
+			}
+			else if (command_word (key, "OFFSET"))
+			{
+				cmd->loc = atoi (value) ;
+			}
+			else if (command_word (key, "SRATE"))
+			{
+				cmd->symbolrate = atoi (value) ;
+				cmd->srcount 	= scan_list_parse (value, cmd->srlist, MAXSRSTOSCAN) ;		// SRATE=sr1,sr2,..
+			}
+			else if (command_word (key, "FPLUG"))
+			{
+				if (*value == 'A')
+				{
+					cmd->antenna = 1 ;
+				}
+				else if (*value == 'B')
+				{
+					cmd->antenna = 2 ;
+				}
+				else
+				{
+					cmd->antenna = -1 ;
+				}
+			}
+			else if (command_word (key, "PRG"))
+			{
+				cmd->prog = atoi (value) ;
+			}
+			else if (command_word (key, "PIDPASS"))									// PIDPASS=256,257,0x120 or NONE
+			{
+				cmd->pidpass = pid_list_parse (value, cmd->pidpasslist) ;
+			}
+			else if (command_word (key, "PIDBLOCK"))								// PIDBLOCK=18,8191 or NONE
+			{
+				cmd->pidblock = pid_list_parse (value, cmd->pidblocklist) ;
+			}
+			else if (command_word (key, "CONSTELLATION"))							// CONSTELLATION=ON, repeated to keep it going, or OFF
+			{
+				if (command_word (value, "OFF"))
+				{
+					cmd->constellation = 0 ;
+				}
+				else if (command_word (value, "ON"))
+				{
+					cmd->constellation = 1 ;
+				}
+			}
+			else if (command_word (key, "TSADD"))									// TSADD=192.168.1.20:10000, repeated to keep it going
+			{
+				cmd->tsadd = subscriber_parse (value, &cmd->tsaddaddr) ;
+			}
+			else if (command_word (key, "TSREMOVE"))								// TSREMOVE=192.168.1.20:10000 or ALL
+			{
+				if (command_word (value, "ALL"))
+				{
+					cmd->tsremove = 2 ;
+				}
+				else
+				{
+					cmd->tsremove = subscriber_parse (value, &cmd->tsremoveaddr) ;
+				}
+			}
+			else if (command_word (key, "VGX"))
+			{
+				cmd->volt = command_vg (value, &vgxen, &vgxsel, &vgxtone) ;
+			}
+			else if (command_word (key, "VGY"))
+			{
+				cmd->volt = command_vg (value, &vgyen, &vgysel, &vgytone) ;
+			}
+			else if (command_word (key, "VOLTAGE"))
+			{
+				n = atoi (value) ;
+				cmd->volt = 1 ;
+				if (n == 0)
+				{
+					vgxen   = 0 ;
+					vgxsel  = 0 ;
+				}
+				else if (n == 13)
+				{
+					vgxen   = 1 ;
+					vgxsel  = 0 ;
+				}
+				else if (n == 18)
+				{
+					vgxen   = 1 ;
+					vgxsel  = 1 ;
+				}
+				else
+				{
+					cmd->volt = 0 ;													// error
+				}
+			}
+			else if (command_word (key, "22KHZ"))
+			{
+				if (command_word (value, "OFF"))
+				{
+					vgxtone = 0 ;
+				}
+				else if (command_word (value, "ON"))
+				{
+					vgxtone = 1 ;
+				}
+			}
+		}
+		while (*pos && *pos != ',' && *pos != ']')									// on to the next item
+		{
+			pos++ ;
+		}
+		if (*pos)
+		{
+			pos++ ;
+		}
+	}
+
+	for (n = 0 ; n < count ; n++)
+	{
+		cmd = &cmds [n] ;
+		if (towh)
+		{
+			cmd->header = 0 ;
+			if (rcvgiven [n])
+			{
+				cmd->header = WHHEADER ;
+				if (port)
+				{
+					cmd->rx -= rxbase ;
+					if (cmd->rx != (int32) port)
+					{
+						cmd->header = 0 ;											// for a different receiver
+					}
+				}
+			}
+		}
+		else if (qt)
+		{
+			cmd->header = QTHEADER ;
+		}
+		if (overflow)
+		{
+			cmd->header = 0 ;														// too many receivers
+		}
+	}
+	if (port == 0 && towh && survey)
+	{
+		cmds[0].survey = 1 ;
+		cmds[0].header = WHHEADER ;
+	}
+	return (count) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 command_clear
+//@
+//@	 set the settings for one receiver of a command to 'not given'
+//@
+//@	 Calling:	cmd			the settings
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void command_clear (struct command* cmd)
+{
+	memset (cmd, 0, sizeof(struct command)) ;
+	cmd->header 		= -1 ;
+	cmd->rx 			= -1 ;
+	cmd->freq 			= -1 ;
+	cmd->loc 			=  0 ;
+	cmd->symbolrate 	= -1 ;
+	cmd->antenna 		= -1 ;
+	cmd->volt 			= -1 ;
+	cmd->prog 			=  0 ;
+	cmd->pidpass 		= -1 ;
+	cmd->pidblock 		= -1 ;
+	cmd->constellation 	= -1 ;
+	cmd->tsadd 			= -1 ;
+	cmd->tsremove 		= -1 ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 command_word
+//@
+//@	 see if a command item starts with a word: a key, or a value such as ON
+//@
+//@	 Calling:	text		position in the command
+//@				word		upper case word
+//@
+//@	 Return:	1 if the word is followed by something other than a letter or digit
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+uint32 command_word (char* text, char* word)
+{
+		uint32		length ;
+
+	length = strlen (word) ;
+	return (strncmp (text, word, length) == 0 && !isalnum (text [length])) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 command_vg
+//@
+//@	 set a voltage generator from a VGX= or VGY= value: OFF, LO, HI, LOT or HIT
+//@	 (T is the 22kHz tone)
+//@
+//@	 Calling:	value		the value
+//@				en			generator enable
+//@				sel			low / high select
+//@				tone		tone enable
+//@
+//@	 Return:	1 if the value is valid, 0 if not (nothing is changed)
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+int32 command_vg (char* value, uint32* en, uint32* sel, uint32* tone)
+{
+	if (command_word (value, "OFF"))
+	{
+		*en   = 0 ;
+		*sel  = 0 ;
+		*tone = 0 ;
+	}
+	else if (command_word (value, "LO"))
+	{
+		*en   = 1 ;
+		*sel  = 0 ;
+		*tone = 0 ;
+	}
+	else if (command_word (value, "HI"))
+	{
+		*en   = 1 ;
+		*sel  = 1 ;
+		*tone = 0 ;
+	}
+	else if (command_word (value, "LOT"))
+	{
+		*en   = 1 ;
+		*sel  = 0 ;
+		*tone = 1 ;
+	}
+	else if (command_word (value, "HIT"))
+	{
+		*en   = 1 ;
+		*sel  = 1 ;
+		*tone = 1 ;
+	}
+	else
+	{
+		return (0) ;
+	}
+	return (1) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 pid_list_parse
+//@
+//@	 convert a comma separated list of PIDs from a command into a bitmap
+//@	 PIDs may be decimal or 0x hex; NONE gives an empty list
+//@
+//@	 Calling:	pos			start of the list
+//@				list		NUMPIDS bit bitmap
+//@
+//@	 Return:	number of PIDs in the list
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+int32 pid_list_parse (char* pos, uint32* list)
+{
+		uint32		pid ;
+		int32		count ;
+		char*		end ;
+
+	memset (list, 0, NUMPIDS / 8) ;
+	count = 0 ;
+	while (isdigit (*pos))
+	{
+		pid = strtoul (pos, &end, 0) ;
+		if (pid < NUMPIDS && ((list [pid >> 5] >> (pid & 31)) & 1) == 0)
+		{
+			list [pid >> 5] |= 1 << (pid & 31) ;
+			count++ ;
+		}
+		pos = end ;
+		if (*pos != ',')
+		{
+			break ;
+		}
+		pos++ ;
+	}
+	return (count) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 scan_list_parse
+//@
+//@	 convert a frequency or symbol rate list from a command into an array
+//@	 entries are separated by commas; first-last/step gives a range
+//@	 e.g. 10491500,10492000 or 10492000-10499000/250
+//@
+//@	 Calling:	pos			start of the list
+//@				list		array for the values
+//@				max			size of the array
+//@
+//@	 Return:	number of values in the list
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+int32 scan_list_parse (char* pos, uint32* list, uint32 max)
+{
+		uint32		value ;
+		uint32		last ;
+		uint32		step ;
+		int32		count ;
+		char*		end ;
+
+	count = 0 ;
+	while (isdigit (*pos) && (uint32) count < max)
+	{
+		value = strtoul (pos, &end, 10) ;
+		pos   = end ;
+		last  = value ;
+		step  = 1 ;
+		if (*pos == '-')													// range
+		{
+			last = strtoul (pos + 1, &end, 10) ;
+			pos  = end ;
+			if (*pos == '/')
+			{
+				step = strtoul (pos + 1, &end, 10) ;
+				pos  = end ;
+			}
+			if (last < value || step == 0)
+			{
+				last = value ;
+				step = 1 ;
+			}
+		}
+		while (value <= last && (uint32) count < max)
+		{
+			list [count++] = value ;
+			value += step ;
+		}
+		if (*pos != ',')
+		{
+			break ;
+		}
+		pos++ ;
+	}
+	return (count) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 survey_start
+//@
+//@	 share a band survey between the idle receivers, which scan their parts in parallel
+//@	 the frequencies are split into contiguous blocks, and every block gets all the symbol rates
+//@	 the blocks are given out NIM A, NIM B, NIM A, NIM B so that the two tuners of a NIM,
+//@	 which share one STV6120 and its frequency calibration, work on separate parts of the band
+//@
+//@	 Calling:	freqs		frequencies (kHz)
+//@				freqcount	number of frequencies
+//@				srs			symbol rates (kS)
+//@				srcount		number of symbol rates
+//@				loc			LNB local oscillator (kHz)
+//@				antenna		1/2 = TOP/BOT
+//@
+//@	 Return:	number of receivers used; 0 if none are idle or a survey is already running
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+uint32 survey_start (uint32* freqs, uint32 freqcount, uint32* srs, uint32 srcount, int32 loc, int32 antenna)
+{
+		uint32				n ;
+		uint32				x ;
+		uint32				rx ;
+		uint32				count ;
+		uint32				first ;
+		uint32				receivers ;
+		uint32				idle [MAXRECEIVERS] ;
+		int32				temp ;
+		struct i2crequest	req ;
+static	const uint32		order [MAXRECEIVERS] = {1, 3, 2, 4} ;			// alternate between the NIMs
+
+	if (surveyrunning)
+	{
+		return (0) ;
+	}
+
+	count = 0 ;																// drop the invalid entries
+	for (x = 0 ; x < freqcount ; x++)
+	{
+		temp = abs ((int32) freqs[x] - loc) ;
+		if (temp >= MINFREQ && temp <= MAXFREQ)
+		{
+			freqs [count++] = freqs [x] ;
+		}
+	}
+	freqcount = count ;
+	count = 0 ;
+	for (x = 0 ; x < srcount ; x++)
+	{
+		if (srs[x] >= MINSR && srs[x] <= MAXSR)
+		{
+			srs [count++] = srs [x] ;
+		}
+	}
+	srcount = count ;
+
+	receivers = 0 ;
+	for (n = 0 ; n < MAXRECEIVERS ; n++)
+	{
+		rx = order [n] ;
+		if (rcv[rx].receiver && (rcv[rx].active == 0 || rcv[rx].scanstate == STATE_IDLE))
+		{
+			idle [receivers++] = rx ;
+		}
+	}
+	if (receivers > freqcount)
+	{
+		receivers = freqcount ;
+	}
+	if (receivers == 0 || srcount == 0)
+	{
+		return (0) ;
+	}
+
+	surveyresultcount = 0 ;
+	surveysteps 	  = freqcount * srcount ;
+	surveystarttime   = monotime_ms() ;
+	surveyrunning 	  = 1 ;
+
+	first = 0 ;
+	for (n = 0 ; n < receivers ; n++)
+	{
+		rx 	  = idle [n] ;
+		count = (freqcount - first) / (receivers - n) ;						// share out what is left
+		if (count > MAXFREQSTOSCAN)
+		{
+			count = MAXFREQSTOSCAN ;
+		}
+
+		memcpy (rcv[rx].frequencies, &freqs [first], count * sizeof(uint32)) ;
+		rcv[rx].freqcount 		= count ;
+		rcv[rx].freqindex 		= 0 ;
+		rcv[rx].enablefreqscan 	= count > 1 ;
+		memcpy (rcv[rx].symbolrates, srs, srcount * sizeof(uint32)) ;
+		rcv[rx].srcount 		= srcount ;
+		rcv[rx].srindex 		= 0 ;
+		rcv[rx].enablesrscan 	= srcount > 1 ;
+		first += count ;
+
+		rcv[rx].highsideloc 	= (int32) rcv[rx].frequencies[0] < loc ;
+		if (rcv[rx].frequencies[0] >= 10490000 && rcv[rx].frequencies[0] < 10500000)
+		{
+			rcv[rx].qo100mode 	= QO100BAND ;
+		}
+		else
+		{
+			rcv[rx].qo100mode 	= QO100NO ;
+		}
+		rcv[rx].requestedfreq 	= rcv[rx].frequencies[0] ;
+		rcv[rx].requestedloc 	= loc ;
+		rcv[rx].hardwarefreq 	= abs ((int32) rcv[rx].requestedfreq - loc) ;
+		if (rcv[rx].qo100mode == QO100BAND)
+		{
+			rcv[rx].hardwarefreq -= rcv[rx].qo100locerror ;
+		}
+		rcv[rx].antenna 		= antenna ;
+		rcv[rx].pmtpid 			= 0 ;
+		rcv[rx].requestedprog 	= 0 ;
+		rcv[rx].forbidden 		= 0 ;
+		rcv[rx].active 			= 1 ;
+		memset ((void*)&rcv[rx].rawinfos, 0, sizeof(rcv[rx].rawinfos)) ;
+		memset ((void*)&rcv[rx].textinfos, 0, sizeof(rcv[rx].textinfos)) ;
+		psi_cache_clear (rx) ;
+		__atomic_fetch_add (&rcv[rx].pidtablechanges, 1, __ATOMIC_RELEASE) ;
+		rcv[rx].rawinfos[STATUS_ANTENNA] = antenna ;
+		rcv[rx].signalacquiredtime 	= 0 ;
+		rcv[rx].signallosttime 		= 0 ;
+		rcv[rx].lastmodulation 		= 0 ;
+		rcv[rx].commandreceivedtime = monotime_ms() ;
+		rcv[rx].timedouttime 		= 0 ;
+		rcv[rx].surveytime 			= 0 ;
+		rcv[rx].surveydone 			= 0 ;
+		rcv[rx].surveying 			= 1 ;
+
+		memset (&req, 0, sizeof(req)) ;
+		req.type 		= I2CREQ_TUNE ;
+		req.rx 			= rx ;
+		req.freq 		= rcv[rx].hardwarefreq ;
+		req.antenna 	= antenna ;
+		req.symbolrate 	= rcv[rx].symbolrates[0] ;
+		req.calibrated 	= rcv[rx].qo100locerror && rcv[rx].qo100mode != QO100NO ;
+		rcv[rx].tsgate 				 = 0 ;
+		rcv[rx].scanstate 			 = STATE_SEARCH ;
+		rcv[rx].rawinfos[STATUS_STATE] = STATE_SEARCH ;
+		i2c_submit (I2CTUNE, &req) ;
+	}
+	tsprocenabled 	= 1 ;
+	lminfoutenabled = 1 ;
+
+	printf ("Survey: %d frequencies, %d symbol rates on %d receivers\r\n", freqcount, srcount, receivers) ;
+	return (receivers) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 survey_finish
+//@
+//@	 when every surveying receiver has completed its part, turn the receivers off
+//@	 and send the survey report to the 4 line status ports
+//@	 the report gives the total time, and the time the parts would have taken one after another
+//@
+//@	 Calling:
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void survey_finish (void)
+{
+		uint32				n ;
+		uint32				rx ;
+		uint32				count ;
+		uint32				receivers ;
+		uint32				elapsed ;
+		uint32				serial ;
+		int32				status ;
+		struct surveyresult*	sp ;
+		struct i2crequest	req ;
+static	char				report [MAXSURVEYRESULTS * 80 + 512] ;
+
+	for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)
+	{
+		if (rcv[rx].surveying && rcv[rx].surveydone == 0)
+		{
+			return ;														// still going
+		}
+	}
+
+	elapsed   = monotime_ms() - surveystarttime ;
+	serial 	  = 0 ;
+	receivers = 0 ;
+	for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)
+	{
+		if (rcv[rx].surveying == 0)
+		{
+			continue ;
+		}
+		serial += rcv[rx].surveytime ;
+		receivers++ ;
+
+		rcv[rx].surveying 			   = 0 ;								// turn the receiver off again
+		rcv[rx].active 				   = 0 ;
+		rcv[rx].tsgate 				   = 0 ;
+		rcv[rx].scanstate 			   = STATE_IDLE ;
+		rcv[rx].rawinfos[STATUS_STATE] = STATE_IDLE ;
+		memset (&req, 0, sizeof(req)) ;
+		req.type 		= I2CREQ_STOP ;
+		req.rx 			= rx ;
+		req.antenna 	= rcv[rx].antenna ;
+		req.symbolrate 	= rcv[rx].symbolrates[0] ;
+		i2c_submit (I2CTUNE, &req) ;
+	}
+	surveyrunning = 0 ;
+
+	count = __atomic_load_n (&surveyresultcount, __ATOMIC_ACQUIRE) ;
+	sprintf (report, " SURVEY  %d steps on %d receivers: %d.%03d s, %d.%03d s if done one after another\r\n",
+		surveysteps, receivers, elapsed / 1000, elapsed % 1000, serial / 1000, serial % 1000) ;
+	sprintf (report+strlen(report), " RX  FREQUENCY     SR    MER  SERVICE\r\n") ;
+	for (n = 0 ; n < count ; n++)
+	{
+		sp = &surveyresults [n] ;
+		sprintf (report+strlen(report), " %2d  %9.3f  %5d  %5.1f  %s\r\n",
+			sp->rx + rxbase, (float) sp->freq / 1000, sp->symbolrate, (float) sp->mer / 10, sp->name) ;
+	}
+	printf ("%s", report) ;
+	sprintf (report+strlen(report), "\r\n") ;
+
+	if (rcv[0].summarysock)
+	{
+	    status = sendto 						
+  		(
+   			rcv[0].summarysock, report, strlen(report) + 1, 0,
+			(struct sockaddr*) &rcv[0].summarysockaddr, sizeof(rcv[0].summarysockaddr) 
+		) ;
+	}
+	if (rcv[0].summary2sock)
+	{
+	    status = sendto 						
+  		(
+   			rcv[0].summary2sock, report, strlen(report) + 1, 0,
+			(struct sockaddr*) &rcv[0].summary2sockaddr, sizeof(rcv[0].summary2sockaddr) 
+		) ;
+	}
+	(void) status ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 psi_packet
+//@
+//@	 add the payload of a PAT, PMT or SDT packet to the section being assembled
+//@	 handles the pointer_field, sections continued over several packets and
+//@	 several sections in one packet; complete sections are passed to psi_section
+//@
+//@	 Calling:	rx			receiver number
+//@				table		PSI_PAT, PSI_PMT or PSI_SDT
+//@				data		188 byte TS packet
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void psi_packet (uint32 rx, uint32 table, uint8* data)
+{
+		struct psiassembler*	pa ;
+		uint32		pid ;
+		uint32		cc ;
+		uint32		index ;
+		uint32		pointer ;
+
+	pa  = &rcv[rx].psiassembler [table] ;
+	pid = (data[1] & 0x1f) * 0x100 + data[2] ;
+	if (pa->pid != pid)											// the PMT pid has changed
+	{
+		pa->pid     = pid ;
+		pa->length  = 0 ;
+		pa->ccvalid = 0 ;
+	}
+
+	if ((data[3] & 0x10) == 0)									// no payload
+	{
+		return ;
+	}
+	cc = data[3] & 0x0f ;										// continuity counter
+	if (pa->ccvalid && cc == pa->cc)							// repeated packet
+	{
+		return ;
+	}
+	if (pa->ccvalid && cc != ((pa->cc + 1) & 0x0f))				// a packet has been lost
+	{
+		pa->length = 0 ;
+	}
+	pa->cc      = cc ;
+	pa->ccvalid = 1 ;
+
+	index = 4 ;
+	if (data[3] & 0x20)											// skip the adaptation field
+	{
+		index += data[4] + 1 ;
+	}
+	if (index >= 188)
+	{
+		return ;
+	}
+
+	if (data[1] & 0x40)											// a section starts in this packet
+	{
+		pointer = data[index++] ;
+		if (pointer > 188 - index)
+		{
+			pa->length = 0 ;
+			return ;
+		}
+		if (pa->length)											// end of the previous section
+		{
+			psi_append (rx, table, &data[index], pointer) ;
+		}
+		pa->length = 0 ;
+		index += pointer ;
+		while (index < 188 && data[index] != 0xff)				// 0xff is stuffing
+		{
+			index += psi_append (rx, table, &data[index], 188 - index) ;
+		}
+	}
+	else if (pa->length)										// continuation of a section
+	{
+		psi_append (rx, table, &data[index], 188 - index) ;
+	}
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 psi_append
+//@
+//@	 copy bytes into the section being assembled, up to the end of the section
+//@	 a complete section is passed to psi_section
+//@
+//@	 Calling:	rx			receiver number
+//@				table		PSI_PAT, PSI_PMT or PSI_SDT
+//@				data		bytes from the packet payload
+//@				count		number of bytes available
+//@
+//@	 Return:	number of bytes used
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+uint32 psi_append (uint32 rx, uint32 table, uint8* data, uint32 count)
+{
+		struct psiassembler*	pa ;
+		uint32		used ;
+		uint32		n ;
+
+	pa   = &rcv[rx].psiassembler [table] ;
+	used = 0 ;
+
+	if (pa->length < 3)											// the header gives the section length
+	{
+		n = 3 - pa->length ;
+		if (n > count)
+		{
+			n = count ;
+		}
+		memcpy (&pa->section [pa->length], data, n) ;
+		pa->length += n ;
+		used       += n ;
+		if (pa->length < 3)
+		{
+			return (used) ;
+		}
+		pa->needed = 3 + ((pa->section[1] & 0x0f) << 8) + pa->section[2] ;
+		if (pa->needed < 12 || pa->needed > PSIMAXSECTION)		// too short for a CRC, or too long
+		{
+			pa->length = 0 ;
+			return (count) ;
+		}
+	}
+
+	n = pa->needed - pa->length ;
+	if (n > count - used)
+	{
+		n = count - used ;
+	}
+	memcpy (&pa->section [pa->length], &data [used], n) ;
+	pa->length += n ;
+	used       += n ;
+
+	if (pa->length == pa->needed)
+	{
+		psi_section (rx, table, pa->section, pa->length) ;
+		pa->length = 0 ;
+	}
+	return (used) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 psi_section
+//@
+//@	 check and parse a complete PAT, PMT or SDT section
+//@	 a section that is the same as the last one parsed is skipped
+//@
+//@	 Calling:	rx			receiver number
+//@				table		PSI_PAT, PSI_PMT or PSI_SDT
+//@				section		section, starting at the table_id
+//@				length		length of the section including the CRC
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void psi_section (uint32 rx, uint32 table, uint8* section, uint32 length)
+{
+const	uint8		tableids [PSITABLES] = {0x00, 0x02, 0x42} ;		// PAT, PMT, SDT actual TS
+		uint32		changedetected ;
+
+	if (section[0] != tableids [table])
+	{
+		return ;
+	}
+	if (psi_cache_hit (rx, table, section, length))				// unchanged
+	{
+		return ;
+	}
+	if (calculateCRC32 (section, length) != 0)					// CRC32 error
+	{
+		return ;
+	}
+
+	changedetected = 0 ;
+	switch (table)
+	{
+		case PSI_PAT:
+			psi_pat (rx, section, length) ;
+		break ;
+		case PSI_PMT:
+			psi_pmt (rx, section, length) ;
+		break ;
+		case PSI_SDT:
+			changedetected = psi_sdt (rx, section, length) ;
+		break ;
+	}
+
+	if (changedetected == 0)									// a new name is parsed again from the next copy
+	{
+		psi_cache_store (rx, table, section, length) ;
+	}
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 psi_pat
+//@
+//@	 select the first PMT with program number > 0, or the requested program
+//@
+//@	 Calling:	rx			receiver number
+//@				section		PAT section with a good CRC
+//@				length		length of the section including the CRC
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void psi_pat (uint32 rx, uint8* section, uint32 length)
+{
+		uint32		index ;
+		uint32		prognumber ;
+		uint32		pmtpid ;
+		uint32		programcount ;
+
+	pmtpid = 0 ; 												// PMT to use
+	programcount = 0 ;											// number of programs
+	index = 8 ;
+	while (index < length - 4)
+	{
+		prognumber = section [index] * 0x100 + section [index + 1] ;
+		index += 2 ;											// point to PMT pid
+		if (prognumber != 0) 
+		{ 
+			if ((rcv[rx].requestedprog == 0) || (prognumber == rcv[rx].requestedprog))									
+			{
+				if (pmtpid == 0)
+				{
+					pmtpid = (section [index] & 0x1f) * 0x100 + section [index + 1] ;
+			    }
+			}	
+	    	programcount++ ;
+		}
+		index += 2 ;
+	}
+	rcv[rx].pmtpid = pmtpid ;
+	rcv[rx].programcount = programcount ;
+	__atomic_fetch_add (&rcv[rx].pidtablechanges, 1, __ATOMIC_RELEASE) ;		// the PMT pid may have changed
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 psi_pmt
+//@
+//@	 extract the video and audio service types from the PMT
+//@	 VLC is sent NEXT if they have changed
+//@
+//@	 Calling:	rx			receiver number
+//@				section		PMT section with a good CRC
+//@				length		length of the section including the CRC
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void psi_pmt (uint32 rx, uint8* section, uint32 length)
+{
+		uint32		index ;
+		uint32		tempu ;
+		uint32		y ;
+		uint32		servicetype ;
+		uint32		audioservicetype ;
+		uint32		videoservicetype ;
+		uint32		changedetected ;
+
+	index = 8 ;													// point to first entry
+// get the PCR pid
+	tempu = (section [index] & 0x1f) * 0x100 + section [index + 1] ;
+	rcv[rx].pcrpid = tempu ;
+	index += 2 ;
+	tempu = (section [index] & 0x0f) * 0x100 + section [index + 1] ; // info length
+	index += tempu + 2 ;										// skip over the info										
+
+	audioservicetype = 0 ;
+	videoservicetype = 0 ;
+	servicetype      = 0 ;								
+
+// look for service types
+	while (index < length - 4)			
+	{							
+		servicetype = section [index] ;							// H264, AAC etc	
+		index++ ;
+		index += 2 ;
+		tempu = (section [index] & 0x0f) * 0x100 + section [index + 1] ; // info length
+		index += tempu + 2 ;									// skip over the info																
+
+		switch (servicetype)
+		{
+			case SERVICE_H262:
+			case SERVICE_H264:
+			case SERVICE_H265:
+				videoservicetype = servicetype ;
+			break ;
+			case SERVICE_MPA:
+			case SERVICE_AAC:
+			case SERVICE_AC3:
+				audioservicetype = servicetype ;
+			break ;
+		}	
+	}
+							
+	__atomic_fetch_add (&rcv[rx].pidtablechanges, 1, __ATOMIC_RELEASE) ;		// the video type may have changed
+	changedetected = 0 ;
+	y = STATUS_VIDEO_TYPE ;
+	if 
+	(
+		((int)videoservicetype != rcv[rx].rawinfos[y]) && 
+		videoservicetype
+	)
+	{
+		if (rcv[rx].rawinfos[y] != 0 || rcv[rx].vlcstopped)
+		{
+			 changedetected++ ;					
+		}			
+		rcv[rx].rawinfos[y] = videoservicetype ;
+		switch (videoservicetype)	
+		{					
+			case SERVICE_H262:
+				sprintf (rcv[rx].textinfos[y], "H262") ; break ;
+			break ;
+			case SERVICE_H264:
+				sprintf (rcv[rx].textinfos[y], "H264") ; break ;
+			break ;
+			case SERVICE_H265:
+				sprintf (rcv[rx].textinfos[y], "H265") ; break ;
+			break ;
+			default:
+				sprintf (rcv[rx].textinfos[y], "%s", "") ; break ;
+			break ;											
+		} ;
+	}
+
+	y = STATUS_AUDIO_TYPE ;
+	if 
+	(
+		((int)audioservicetype != rcv[rx].rawinfos[y]) && 
+		audioservicetype
+	)
+	{
+		if (rcv[rx].rawinfos[y] != 0 || rcv[rx].vlcstopped)
+		{
+			 changedetected++ ;					
+		}			
+		rcv[rx].rawinfos[y] = audioservicetype ;
+		switch (audioservicetype)
+		{
+			case SERVICE_MPA:
+				sprintf (rcv[rx].textinfos[y], "MPA") ; break ;
+			break ;
+			case SERVICE_AAC:
+				sprintf (rcv[rx].textinfos[y], "AAC") ; break ;
+			break ;
+			case SERVICE_AC3:
+				sprintf (rcv[rx].textinfos[y], "AC3") ; break ;
+			break ;
+			default:
+				sprintf (rcv[rx].textinfos[y], "%s", "") ; break ;
+			break ;
+		}					
+	}
+
+	if (changedetected)
+	{										
+	 	rcv[rx].vlcstopped = 0 ;
+		y = STATUS_VIDEO_TYPE ;
+		rcv[rx].rawinfos[y]= videoservicetype ;
+		y = STATUS_AUDIO_TYPE ;
+		rcv[rx].rawinfos[y] = audioservicetype ;
+		rcv[rx].modechanges++ ;									// count a mode change
+		rcv[rx].vlcnextcount++ ;
+		if (rcv[rx].xdotoolid)
+		{
+			vlc_key (rx, 'n', 0) ;								// send NEXT to VLC
+		}
+	}
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 psi_sdt
+//@
+//@	 extract the service provider and service name from the first SDT entry
+//@	 VLC is sent NEXT if the service name has changed
+//@
+//@	 Calling:	rx			receiver number
+//@				section		SDT section with a good CRC
+//@				length		length of the section including the CRC
+//@
+//@	 Return:	non zero if the service name has changed
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+uint32 psi_sdt (uint32 rx, uint8* section, uint32 length)
+{
+		uint8		*sdtp ;
+		uint32		length1 ;
+		uint32		length2 ;
+		uint32		y ;
+		uint32		changedetected ;
+		char		temps  [256] ;
+
+	changedetected = 0 ;
+	if (length < 11 + 5 + 4)									// no service entry
+	{
+		return (0) ;
+	}
+	sdtp = section ;
+	sdtp += 11 ;												// point to the first entry
+	rcv[rx].serviceid  = *sdtp++ * 0x100 ;						// 16 bit service ID, high/low
+	rcv[rx].serviceid += *sdtp++ ;
+	sdtp += 3 ;													// point to the descriptor tag
+	if (*sdtp == 0x48)											// service descriptor
+	{					
+		sdtp += 3 ;												// point to the provider length
+		length1 = *sdtp++ ;										// provider length
+		if (length1 <=  15)
+		{
+			length2 = length1 ;
+		}
+			else
+		{
+			length2 = 15 ;
+		}
+		y = STATUS_SERVICE_PROVIDER_NAME ; 
+		strncpy (rcv[rx].textinfos[y], (void*)sdtp, length2) ; 	// copy the provider name
+		rcv[rx].textinfos[y][length2] = 0 ;						// terminate the string
+		sdtp += length1 ;										// point to the service name length 
+		length1 = *sdtp++ ;										// service name length 
+		if (length1 <=  15)
+		{
+			length2 = length1 ;
+		}
+			else
+		{
+			length2 = 15 ;
+		}
+		y = STATUS_SERVICE_NAME ; 								// callsign
+		if (rcv[rx].programcount != 1 && rcv[rx].textinfos[y][0])
+		{
+			strcpy (temps, "+") ;
+			strncat (temps, (void*)sdtp, length2) ; 			// copy the service name
+			temps [length2+1] = 0 ;								// terminate the string	
+		}
+		else
+		{
+			strcpy (temps, "") ;
+			strncat (temps, (void*)sdtp, length2) ; 			// copy the service name
+			temps [length2] = 0 ;								// terminate the string	
+		}
+		if (strcmp(temps,rcv[rx].textinfos[y]) != 0)
+		{
+			changedetected++ ;
+			rcv[rx].modechanges++ ;								// count a mode change			
+			rcv[rx].packetcountrx  	   		= 0 ;				// clear packet count		
+			rcv[rx].nullpacketcountrx  		= 0 ;				// clear null packet count	
+		 	if (rcv[rx].textinfos[y][0] || rcv[rx].vlcstopped)
+		 	{
+				rcv[rx].vlcstopped = 0 ;
+				rcv[rx].vlcnextcount++ ;
+				rcv[rx].rawinfos[STATUS_VLCNEXTS] = rcv[rx].vlcnextcount ;
+				if (rcv[rx].xdotoolid) 
+				{
+					vlc_key (rx, 'n', 0) ;						// send NEXT to VLC
+				}
+			}
+		}
+		strcpy (rcv[rx].textinfos[y], temps) ;					// copy the service name
+	}
+	return (changedetected) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 psi_cache_hit
+//@
+//@	 see if a PSI section is the same as the last one parsed for this table
+//@	 the table_id, version_number and CRC are compared before the whole section
+//@
+//@	 Calling:	rx			receiver number
+//@				table		PSI_PAT, PSI_PMT or PSI_SDT
+//@				section		section, starting at the table_id
+//@				length		length of the section including the CRC
+//@
+//@	 Return:	1 if the section is unchanged and need not be parsed
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+uint32 psi_cache_hit (uint32 rx, uint32 table, uint8* section, uint32 length)
+{
+		struct psicache*	pc ;
+
+	pc = &rcv[rx].psicache [table] ;
+	if
+	(
+		pc->valid 									&&
+		(pc->length  == length) 					&&
+		(pc->tableid == section [0])				&&
+		(pc->version == (section [5] & 0x3e))		&&
+		(pc->hash    == *(uint32*)&section [length - 4])	&&
+		(memcmp (pc->section, section, length) == 0)
+	)
+	{
+		rcv[rx].psihits++ ;
+		return (1) ;
+	}
+	rcv[rx].psimisses++ ;
+	return (0) ;
+}
 
-				setup_titlebar (titlebar, rx) ;										// create the VLC title bar
 
-				if (rcv[rx].xdotoolid)
-				{				
-					if ((modex != MODE_MULTICAST) && (rcv[rx].iptype != IP_MYPC))
-					{
-						sprintf (titlebar, "%d: *TS diverted to another location*", rx) ;
-					}			
-					else
-					{
-						setup_titlebar (titlebar, rx) ;								// create the VLC title bar
-					}
-					sprintf (temps,"xdotool set_window --name \"%s\" %d ", titlebar, rcv[rx].xdotoolid) ;
-					system (temps) ;
-				}
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 psi_cache_store
+//@
+//@	 remember a PSI section that has passed its CRC check and been parsed
+//@
+//@	 Calling:	rx			receiver number
+//@				table		PSI_PAT, PSI_PMT or PSI_SDT
+//@				section		section, starting at the table_id
+//@				length		length of the section including the CRC
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 
-				setup_titlebar (titlebar, rx) ;										// create the VLC title bar
-				strcpy (rcv[rx].textinfos[STATUS_TITLEBAR], titlebar) ;				
+void psi_cache_store (uint32 rx, uint32 table, uint8* section, uint32 length)
+{
+		struct psicache*	pc ;
 
+	pc = &rcv[rx].psicache [table] ;
+	pc->valid = 0 ;
+	if (length >= 8 && length <= PSIMAXSECTION)
+	{
+		pc->length  = length ;
+		pc->tableid = section [0] ;
+		pc->version = section [5] & 0x3e ;						// version_number
+		pc->hash    = *(uint32*)&section [length - 4] ;		// the CRC
+		memcpy (pc->section, section, length) ;
+		pc->valid   = 1 ;
+	}
+}
 
-// send a modified EIT packet to be displayed in the VLC title bar
 
-				if (eitinsert && rcv[rx].iptype != IP_MYPC)															// this function is enabled
-				{
-					if ((counter & 1) == 0)
-					{
-						if ((counter & 3) == 0)
-						{
-							rcv[rx].eitversion++ ;
-						}	
-						setup_eit ((void*)&command, rx, titlebar) ;
-						if 
-						(
-							(rcv[rx].scanstate != STATE_TIMEOUT && rcv[rx].scanstate != STATE_IDLE) || 
-							rcv[rx].timeoutholdoffcount != 0
-						)
-						{
-		                    status = sendto
-    		                (
-	    		            	rcv[rx].tssock, (char*)&command, 188, 0,
-	            	            (struct sockaddr*) &rcv[rx].tssockaddr, sizeof(rcv[rx].tssockaddr)
-    	            	    ) ;
-        	            	(void) status ;                                                      
-            	        }
-            	    }
-				}
-            } 
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 psi_cache_clear
+//@
+//@	 ask the TS thread to forget the PSI sections for a receiver so that the next ones are parsed,
+//@	 and to drop any sections being assembled from the previous reception
+//@	 used when a new reception starts and the infos from the tables are cleared
+//@	 the cache belongs to the TS thread, so any thread may call this; set psiclearname first
+//@	 to have the service name cleared at the same time
+//@
+//@	 Calling:	rx			receiver number
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 
-            if (rcv[rx].active == 0)
-            {
-               	strcpy (temps2, "") ;
-            }
-            else
-            {
-				if (rcv[rx].packetcountrx < 10000000)
-				{
-					sprintf (temps2,"%7d", rcv[rx].packetcountrx) ;
-				}
-				else
-				{
-					sprintf (temps2, 	 "%-.6fM", (float) rcv[rx].packetcountrx / 1000000) ;	
-					if (strlen(temps2) > 7)
-					{
-						sprintf (temps2 + 6, "M") ;	
-					}
-				}
-			}
+void psi_cache_clear (uint32 rx)
+{
+	__atomic_fetch_add (&rcv[rx].psiclears, 1, __ATOMIC_RELEASE) ;					// done by tsproc_packet
+}
 
-			strncpy (temps3, rcv[rx].textinfos[STATUS_SERVICE_NAME], sizeof(temps3)-1) ;
-		    temps3 [15] = 0 ;
 
-			y = STATUS_TS_NULL_PERCENTAGE ;
-			sprintf 
-			(
-				rcv[rx].textinfos[y], 
-				"%0.1f", 
-				(float) 99.9 * rcv[rx].nullpacketcountrx / (rcv[rx].packetcountrx + 1)
-			) ;
-			rcv[rx].rawinfos[y] = atof (rcv[rx].textinfos[y]) + 0.5 ; 			
-	
-			sprintf 
-			(
-				temps,
-				"%1s%1s%2s",									
-				rcv[rx].textinfos[STATUS_FRAME_TYPE], 
-				rcv[rx].textinfos[STATUS_PILOTS], 
-				rcv[rx].textinfos[STATUS_ROLLOFF]
-			) ;
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 psi_cache_reset
+//@
+//@	 forget the PSI sections for a receiver, as asked for by psi_cache_clear
+//@	 only called from the TS thread, which parses into the cache
+//@
+//@	 Calling:	rx			receiver number
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 
-// start building the info line for this rx
-		     
-	       	sprintf 
-       		(
-       			output + strlen(output),
-               	" %2d  %-7s  %-15s  %5s  %5s  %9s  %5s  %-11s  ",  
-   	            rx + rxbase, 
-       			rcv[rx].textinfos [STATUS_STATE], 	
-				temps3,						       				// rcv[rx].textinfos[STATUS_SERVICE_NAME]
-       			rcv[rx].textinfos [STATUS_MER],
-  				rcv[rx].textinfos [STATUS_DNUMBER],
-      			rcv[rx].textinfos [STATUS_CARRIER_FREQUENCY],	
-       			rcv[rx].textinfos [STATUS_SYMBOL_RATE],
-      			rcv[rx].textinfos [STATUS_MODCOD]
-			) ;
+void psi_cache_reset (uint32 rx)
+{
+		uint32		table ;
+		uint32		clears ;
 
-			sprintf (temps3, "%s-%s", rcv[rx].textinfos[STATUS_VIDEO_TYPE],rcv[rx].textinfos [STATUS_AUDIO_TYPE]) ;
-			if (strlen(temps3) == 1)
-			{	
-				strcpy (temps3, "") ;
-			}
+	clears = __atomic_load_n (&rcv[rx].psiclears, __ATOMIC_ACQUIRE) ;
+	for (table = 0 ; table < PSITABLES ; table++)
+	{
+		rcv[rx].psicache[table].valid      = 0 ;
+		rcv[rx].psiassembler[table].length = 0 ;
+		rcv[rx].psiassembler[table].ccvalid = 0 ;
+	}
+	if (rcv[rx].psiclearname)
+	{
+		rcv[rx].psiclearname = 0 ;
+		rcv[rx].textinfos [STATUS_SERVICE_NAME][0] = 0 ;
+	}
+	__atomic_store_n (&rcv[rx].psiclearsdone, clears, __ATOMIC_RELEASE) ;
+}
 
-	       	sprintf 
-       		(
-       			output + strlen(output),
-               	"%-4s  %-8s  %3s  %7s  %4s  %-8s  ",    						
-				temps,											// FPRO
-				temps3,											// video-audio	
-      			rcv[rx].textinfos [STATUS_ANTENNA],
-				temps2,											// packetcount
-      			rcv[rx].textinfos [STATUS_TS_NULL_PERCENTAGE],
-                rcv[rx].nimtype
-       		) ;
 
-			strcat  (outputonnet, output) ;						// add the output line 			
-			sprintf (outputonnet+strlen(outputonnet), "%-15s", rcv[rx].ipaddress) ;	// TS destination
-	       	sprintf (outputonnet+strlen(outputonnet), "\r\n") ;			
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 tsout_packet
+//@
+//@	 add a TS packet to the UDP datagram being built for a receiver
+//@	 the datagram is queued when it holds tsudppackets packets
+//@
+//@	 Calling:	rx			receiver number
+//@				packet		188 byte TS packet
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 
-			strcat  (outputoffnet, output) ;					// add the output line 			
-			tempu = inet_addr (rcv[rx].ipaddress) ;				// convert to numeric
-			tempu &= 0xffff ;									// mask off the 2 lower numbers
-			sia.s_addr = tempu ;
-			sprintf (outputoffnet+strlen(outputoffnet), "%-15s", inet_ntoa(sia)) ;	// masked TS destination
-	       	sprintf (outputoffnet+strlen(outputoffnet), "\r\n") ;			
+void tsout_packet (uint32 rx, uint8* packet)
+{
+		uint32		d ;
 
-// end of the loop for each receiver
+	d = rcv[rx].tsoutdgrams ;
+	if (rcv[rx].tsoutcount == 0)
+	{
+		rcv[rx].tsouttime = monotime_ms() ;							// start of the hold time
+	}
+	memcpy (&rcv[rx].tsoutbuff [d][rcv[rx].tsoutcount * 188], packet, 188) ;
+	rcv[rx].tsoutcount++ ;
 
-// build the original LM $ text info for an individual receiver
-     
-        	sprintf (temps, "%s", "") ;
-			for (y = 1 ; y <= STATUS_LNB_POLARISATION_H ; y++)
-			{
-				if (rcv[rx].textinfos[y][0])
-				{
-					if (y == STATUS_SERVICE_NAME || y == STATUS_SERVICE_PROVIDER_NAME)
-					{
-						sprintf (temps+strlen(temps), "$%d,%s\r\n", y, rcv[rx].textinfos[y]) ;
-					}
-					else				
-					{
-						sprintf (temps+strlen(temps), "$%d,%d\r\n", y, rcv[rx].rawinfos[y]) ;
-					}
-				}
-			}
+	if (rcv[rx].tsoutcount >= tsudppackets)
+	{
+		tsout_queue (rx) ;
+	}
+}
 
-// send the orginal LM $ text info for this receiver
 
-			if 
-			(
-				(rcv[rx].scanstate != STATE_TIMEOUT && rcv[rx].scanstate != STATE_IDLE) || 
-				rcv[rx].timeoutholdoffcount != 0
-			)
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 tsout_queue
+//@
+//@	 queue the datagram being built for a receiver, to be sent by tsout_send
+//@	 the queue is sent immediately if it is full
+//@
+//@	 Calling:	rx			receiver number
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void tsout_queue (uint32 rx)
+{
+	if (rcv[rx].tsoutcount)
+	{
+		rcv[rx].tsoutlength [rcv[rx].tsoutdgrams] = rcv[rx].tsoutcount * 188 ;
+		rcv[rx].tsoutdgrams++ ;
+		rcv[rx].tsoutcount = 0 ;
+		if (rcv[rx].tsoutdgrams >= MAXTSOUTDGRAMS)
+		{
+			tsout_send (rx) ;
+		}
+	}
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 tsout_send
+//@
+//@	 send all the queued datagrams for a receiver with one sendmmsg call
+//@	 datagrams that cannot be sent because the socket buffers are full are dropped
+//@	 a datagram refused for any other reason is dropped on its own and the rest are still sent
+//@
+//@	 Calling:	rx			receiver number
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void tsout_send (uint32 rx)
+{
+		uint32				d ;
+		uint32				k ;
+		uint32				n ;
+		uint32				dests ;
+		uint32				total ;
+		uint32				sent ;
+		int32				status ;
+		uint32				generation ;
+		struct subscriber*	sp ;
+		struct subscriber*	owners [MAXSUBSCRIBERS + 1] ;
+		struct sockaddr_in	addrs  [MAXSUBSCRIBERS + 1] ;
+		struct mmsghdr		msgs   [MAXTSOUTDGRAMS * (MAXSUBSCRIBERS + 1)] ;
+		struct iovec		iovs   [MAXTSOUTDGRAMS] ;
+
+	if (rcv[rx].tsoutdgrams == 0)
+	{
+		return ;
+	}
+
+	if (rcv[rx].tssock)
+	{
+		owners [0] = 0 ;															// the receiver's own destination
+		addrs  [0] = rcv[rx].tssockaddr ;
+		dests 	   = 1 ;
+		for (n = 0 ; n < MAXSUBSCRIBERS ; n++)
+		{
+			sp = &rcv[rx].subscribers[n] ;
+			if (__atomic_load_n (&sp->active, __ATOMIC_ACQUIRE) == 0)
 			{
-				if (rcv[rx].lminfosock)						// valid socket
-				{
-			        status = sendto 						// send to base port + 60 + receiver (1-4)
-    			  	(
-   	    			   	rcv[rx].lminfosock, (char*)temps, strlen(temps) + 1, 0,
-	    	   			(struct sockaddr*) &rcv[rx].lminfosockaddr, sizeof(rcv[rx].lminfosockaddr) 
-					) ;
-   					(void) status ;
-				}
+				continue ;
+			}
+			generation = __atomic_load_n (&sp->generation, __ATOMIC_ACQUIRE) ;
+			if (generation & 1)
+			{
+				continue ;															// being added: next time
+			}
+			addrs [dests] = sp->addr ;												// copied, as the main thread may
+			__atomic_thread_fence (__ATOMIC_ACQUIRE) ;								// . . reuse the entry at any time
+			if (__atomic_load_n (&sp->generation, __ATOMIC_RELAXED) != generation)
+			{
+				continue ;
+			}
+			if (sp->countgeneration != generation)								// a new subscriber in this entry
+			{
+				sp->datagrams 		= 0 ;
+				sp->drops 			= 0 ;
+				sp->countgeneration = generation ;
 			}
+			owners [dests] = sp ;
+			dests++ ;
 		}
-		
-// end of the 4 receiver loop
 
-		for (rx = 1 ; rx <= 4 ; rx++)
+		total = 0 ;
+		memset (msgs, 0, rcv[rx].tsoutdgrams * dests * sizeof(struct mmsghdr)) ;
+		for (d = 0 ; d < rcv[rx].tsoutdgrams ; d++)
 		{
-			if (rcv[rx].active == 0)
+			iovs[d].iov_base 				= rcv[rx].tsoutbuff [d] ;
+			iovs[d].iov_len 				= rcv[rx].tsoutlength [d] ;
+			for (k = 0 ; k < dests ; k++)										// the same datagram to each destination
 			{
-				sprintf (outputonnet+strlen(outputonnet), "\r\n") ;
-				sprintf (outputoffnet+strlen(outputoffnet), "\r\n") ;
+				msgs[total].msg_hdr.msg_iov 		= &iovs[d] ;
+				msgs[total].msg_hdr.msg_iovlen 		= 1 ;
+				msgs[total].msg_hdr.msg_name 		= &addrs[k] ;
+				msgs[total].msg_hdr.msg_namelen 	= sizeof(struct sockaddr_in) ;
+				total++ ;
 			}
-		}		
-
-		printf ("%c[6A",ESC) ;						// UP cursor tp prevent scrolling
-   	   	printf ("%s", outputonnet) ;
-
-// send info
+		}
 
-		for (rx = 0 ; rx <= MAXRECEIVERS ; rx++)
+		sent = 0 ;
+		while (sent < total)
 		{
-			if (1)
+			status = sendmmsg (rcv[rx].tssock, &msgs[sent], total - sent, MSG_DONTWAIT) ;
+			rcv[rx].tssyscalls++ ;
+			if (status > 0)
 			{
-				if 
-				(
-					rx == 0 ||
-					(rcv[rx].scanstate != STATE_TIMEOUT && rcv[rx].scanstate != STATE_IDLE) || 
-					rcv[rx].timeoutholdoffcount != 0		// send info a few times after timeout
-				)
-				{
-
-					if (rcv[rx].antenna == 1)
+				for (n = sent ; n < sent + status ; n++)						// the receiver's counts are for
+				{																// . . its own destination only
+					if (owners [n % dests])
 					{
-						sprintf (rcv[rx].textinfos[STATUS_ANTENNA], "TOP") ;
+						owners [n % dests]->datagrams++ ;
 					}
-					else if (rcv[rx].antenna == 2)
+					else
 					{
-						sprintf (rcv[rx].textinfos[STATUS_ANTENNA], "BOT") ;
+						rcv[rx].tsdatagrams++ ;
 					}
-							
-// send expanded LM $ text info 
-			     
-			   		strcpy (temps, "") ;									// expanded LM info
-		        	sprintf (temps+strlen(temps),"$0,%d\r\n", rx + rxbase) ;
-					sprintf (rcv[rx].textinfos[STATUS_VLCSTOPS], "%d", rcv[rx].vlcstopcount) ;
-					sprintf (rcv[rx].textinfos[STATUS_VLCNEXTS], "%d", rcv[rx].vlcnextcount) ;
-					for (y = 1 ; y < MAXINFOS ; y++)
+				}
+				sent += status ;
+			}
+			else
+			{
+				if ((status < 0) && ((errno == EAGAIN) || (errno == EWOULDBLOCK) || (errno == ENOBUFS)))
+				{
+					for (n = sent ; n < total ; n++)							// socket buffers are full
 					{
-						if (rcv[rx].textinfos[y][0])
+						if (owners [n % dests])
 						{
-							sprintf (temps+strlen(temps), "$%d,%s\r\n", y, rcv[rx].textinfos[y]) ;
+							owners [n % dests]->drops++ ;
 						}
-					}
-				
-					if (rcv[rx].expinfosock)		// valid socket
-					{
-	    			    status = sendto 						
-   						(
-			    	   		rcv[rx].expinfosock, (char*)temps, strlen(temps) + 1, 0,
-  							(struct sockaddr*) &rcv[rx].expinfosockaddr, sizeof(rcv[rx].expinfosockaddr) 
-						) ;
-					}
-					if (rcv[rx].expinfo2sock)		// valid socket
-					{
-	    			    status = sendto 			// duplicate to next port
-	    	  			(
-  					   		rcv[rx].expinfo2sock, (char*)temps, strlen(temps) + 1, 0,
-	   			   			(struct sockaddr*) &rcv[rx].expinfo2sockaddr, sizeof(rcv[rx].expinfo2sockaddr) 
-						) ;
-		  				(void) status ;
-					}
-					temp = 0 ;
-					for (y = 0 ; y < rx ; y++)				// check if already sent to this address
-					{
-						if 
-						(
-							(rcv[y].scanstate != STATE_TIMEOUT && rcv[y].scanstate != STATE_IDLE) || 
-							rcv[y].timeoutholdoffcount != 0
-						)
+						else
 						{
-							if (strcmp(rcv[y].ipaddress,rcv[rx].ipaddress) == 0)
-							{
-								temp++ ;						// already sent to this address
-							}						
+							rcv[rx].tsdrops++ ;
 						}
 					}
-					
-// send 4 line info
+					break ;
+				}
+				if (owners [sent % dests])										// e.g. no route to this destination
+				{
+					owners [sent % dests]->drops++ ;
+				}
+				else
+				{
+					rcv[rx].tsdrops++ ;
+				}
+				sent++ ;														// skip it and send the rest
+			}
+		}
+	}
 
-   					if ((rx == 0) || (temp == 0))				// haven't already sent to this address
-					{
-						if (rcv[rx].iptype == IP_OFFNET)		// mask TS destinations for off net
-						{
-							if (rcv[rx].summarysock)			// valid socket
-							{
-			    			    status = sendto 						
-			   		  			(
-				    	   			rcv[rx].summarysock, (char*)outputoffnet, strlen(outputoffnet) + 1, 0,
-	   					   			(struct sockaddr*) &rcv[rx].summarysockaddr, sizeof(rcv[rx].summarysockaddr) 
-								) ;
-   								(void) status ;
-							}
-							if (rcv[rx].summary2sock)			// valid socket
-							{
-			    			    status = sendto 						
-			   		  			(
-				    	   			rcv[rx].summary2sock, (char*)outputoffnet, strlen(outputoffnet) + 1, 0,
-	   					   			(struct sockaddr*) &rcv[rx].summary2sockaddr, sizeof(rcv[rx].summary2sockaddr) 
-								) ;
-   								(void) status ;
-							}
-						}
-						else									// on net
-						{
-							if (rcv[rx].summarysock)			// valid socket
-							{
-			    			    status = sendto 						
-			   		  			(
-				    	   			rcv[rx].summarysock, (char*)outputonnet, strlen(outputonnet) + 1, 0,
-	   					   			(struct sockaddr*) &rcv[rx].summarysockaddr, sizeof(rcv[rx].summarysockaddr) 
-								) ;
-   								(void) status ;
-							}
-							if (rcv[rx].summary2sock)			// valid socket
-							{
-			    			    status = sendto 						
-			   		  			(
-				    	   			rcv[rx].summary2sock, (char*)outputonnet, strlen(outputonnet) + 1, 0,
-	   					   			(struct sockaddr*) &rcv[rx].summary2sockaddr, sizeof(rcv[rx].summary2sockaddr) 
-								) ;
-   								(void) status ;
-							}
-						}
-					}
-  				}				
-   			}
-   			if (rcv[rx].timeoutholdoffcount)
-   			{
-	   			rcv[rx].timeoutholdoffcount-- ;		// decrement the holdoff count
-   			}
-		}		
+	rcv[rx].tsoutdgrams = 0 ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 tsout_flush
+//@
+//@	 queue the datagrams that have been held for tsflushtime or more,
+//@	 then send the queued datagrams for all receivers
+//@	 called once for each wakeup of tsproc_loop
+//@
+//@	 Calling:
+//@
+//@	 Return:	time until the next datagram must be sent (ms), 500 if none are held
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+uint32 tsout_flush (void)
+{
+		uint32		rx ;
+		uint32		nowms ;
+		uint32		heldms ;
+		uint32		waitms ;
+
+	nowms  = monotime_ms() ;
+	waitms = 500 ;
+	for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)
+	{
+		if (rcv[rx].tsoutcount)
+		{
+			heldms = nowms - rcv[rx].tsouttime ;
+			if (heldms >= tsflushtime)
+			{
+				tsout_queue (rx) ;
+			}
+			else if (tsflushtime - heldms < waitms)
+			{
+				waitms = tsflushtime - heldms ;
+			}
+		}
+		tsout_send (rx) ;
+	}
+	return (waitms) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 subscriber_parse
+//@
+//@	 convert a TS destination from a command: IP address and port, e.g. 192.168.1.20:10000
+//@
+//@	 Calling:	pos			start of the destination
+//@				addr		address for the result
+//@
+//@	 Return:	1 if valid, 0 if not
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+int32 subscriber_parse (char* pos, struct sockaddr_in* addr)
+{
+		char		ip [16] ;
+		uint32		n ;
+		int32		port ;
+
+	for (n = 0 ; n < sizeof(ip) - 1 && (isdigit (pos[n]) || pos[n] == '.') ; n++)
+	{
+		ip [n] = pos [n] ;
+	}
+	ip [n] = 0 ;
+	if (pos[n] != ':')
+	{
+		return (0) ;
+	}
+	port = atoi (&pos[n+1]) ;
+
+	memset (addr, 0, sizeof(struct sockaddr_in)) ;
+	addr->sin_family = AF_INET ;
+	addr->sin_port   = htons (port) ;
+	if (inet_aton (ip, &addr->sin_addr) == 0 || port <= 0 || port > 65535)
+	{
+		return (0) ;
+	}
+	return (1) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 subscriber_add
+//@
+//@	 add an extra destination for a receiver's TS, or restart its timeout if it is already there
+//@	 the sockets and the reception are not changed
+//@
+//@	 Calling:	rx			receiver number
+//@				addr		IP address and port
+//@
+//@	 Return:	1 if done, 0 if the receiver already has MAXSUBSCRIBERS
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+uint32 subscriber_add (uint32 rx, struct sockaddr_in* addr)
+{
+		uint32				n ;
+		uint32				free ;
+		struct subscriber*	sp ;
+
+	free = MAXSUBSCRIBERS ;
+	for (n = 0 ; n < MAXSUBSCRIBERS ; n++)
+	{
+		sp = &rcv[rx].subscribers[n] ;
+		if (sp->active)
+		{
+			if (sp->addr.sin_addr.s_addr == addr->sin_addr.s_addr && sp->addr.sin_port == addr->sin_port)
+			{
+				sp->refreshtime = monotime_ms() ;
+				return (1) ;
+			}
+		}
+		else if (free == MAXSUBSCRIBERS)
+		{
+			free = n ;
+		}
+	}
+	if (free == MAXSUBSCRIBERS)
+	{
+		return (0) ;
+	}
+
+	sp = &rcv[rx].subscribers[free] ;
+	__atomic_store_n (&sp->generation, sp->generation + 1, __ATOMIC_RELAXED) ;		// odd: tsout_send keeps away
+	__atomic_thread_fence (__ATOMIC_RELEASE) ;
+	sp->addr 		= *addr ;
+	sp->refreshtime = monotime_ms() ;
+	__atomic_store_n (&sp->generation, sp->generation + 1, __ATOMIC_RELEASE) ;		// the counts are reset by tsout_send
+	__atomic_store_n (&sp->active, 1, __ATOMIC_RELEASE) ;							// seen by tsout_send
+	printf ("RX%d TS subscriber %s:%d added\r\n", rx, inet_ntoa (addr->sin_addr), ntohs (addr->sin_port)) ;
+	return (1) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 subscriber_remove
+//@
+//@	 remove one or all of the extra destinations for a receiver's TS
+//@
+//@	 Calling:	rx			receiver number
+//@				addr		IP address and port; 0 for all
+//@				reason		for the message
+//@
+//@	 Return:	number removed
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+uint32 subscriber_remove (uint32 rx, struct sockaddr_in* addr, char* reason)
+{
+		uint32				n ;
+		uint32				count ;
+		struct subscriber*	sp ;
+
+	count = 0 ;
+	for (n = 0 ; n < MAXSUBSCRIBERS ; n++)
+	{
+		sp = &rcv[rx].subscribers[n] ;
+		if (sp->active && 
+			(addr == 0 || (sp->addr.sin_addr.s_addr == addr->sin_addr.s_addr && sp->addr.sin_port == addr->sin_port)))
+		{
+			__atomic_store_n (&sp->active, 0, __ATOMIC_RELEASE) ;
+			printf ("RX%d TS subscriber %s:%d %s after %u datagrams, %u dropped\r\n", rx,
+				inet_ntoa (sp->addr.sin_addr), ntohs (sp->addr.sin_port), reason,
+				sp->countgeneration == sp->generation ? sp->datagrams : 0,
+				sp->countgeneration == sp->generation ? sp->drops : 0) ;
+			count++ ;
+		}
+	}
+	return (count) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 subscriber_expire
+//@
+//@	 remove the TS subscribers which have not been added again for subscribertime seconds
+//@	 called by the main loop
+//@
+//@	 Calling:
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void subscriber_expire (void)
+{
+		uint32				rx ;
+		uint32				n ;
+		uint32				nowms ;
+		struct subscriber*	sp ;
+
+	if (subscribertime == 0)
+	{
+		return ;
 	}
+	nowms = monotime_ms() ;
+	for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)
+	{
+		for (n = 0 ; n < MAXSUBSCRIBERS ; n++)
+		{
+			sp = &rcv[rx].subscribers[n] ;
+			if (sp->active && nowms - sp->refreshtime >= subscribertime * 1000)
+			{
+				subscriber_remove (rx, &sp->addr, "timed out") ;
+			}
+		}
+	}
+}
+
 
-	i2csharedaccess = I2CMAINHAS ;					// give i2c access to main loop	if this loop ever exits		
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 vlc_key
+//@
+//@	 queue a key press for a receiver's VLC window and wake the VLC control thread
+//@	 the key press is dropped if the queue is full
+//@
+//@	 Calling:	rx			receiver number
+//@				key			's' stop, 'n' next
+//@				focus		1 if the window is to be focused first
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 
-	printf ("INFO   thread exiting\r\n") ;
-	return (0) ;
+void vlc_key (uint32 rx, char key, uint32 focus)
+{
+	pthread_mutex_lock (&vlcmutex) ;
+	if (vlckeycount < VLCQUEUESIZE)
+	{
+		vlckeys[vlckeycount].rx    = rx ;
+		vlckeys[vlckeycount].key   = key ;
+		vlckeys[vlckeycount].focus = focus ;
+		vlckeycount++ ;
+		pthread_cond_signal (&vlccond) ;
+	}
+	else
+	{
+		vlckeydrops++ ;
+	}
+	pthread_mutex_unlock (&vlcmutex) ;
 }
 
 
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@
-//@	 tsproc
+//@	 vlc_title
 //@
-//@	 a thread to process incoming packets and send them via UDP
+//@	 set the title bar for a receiver's VLC window
+//@	 a title bar which is the same as the last one is only sent every VLCTITLEREFRESH,
+//@	 and one which has not been sent yet is replaced by the new one
 //@
-//@	 Calling:	
+//@	 Calling:	rx			receiver number
+//@				title		title bar text
 //@
-//@	 Return:	
+//@	 Return:
 //@
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
 //@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
-    	
-void* tsproc_loop (void* dummy)
+
+void vlc_title (uint32 rx, char* title)
 {
-		int			x ;
-		uint8		tempc ;
-		uint32		tempu ;
-		char		temps  [256] ;
-		char		temps2 [256] ;
-		uint32		index ;
-		uint32		rx ;
-		int32		status ;
-		packetx_t	*pp ;
-		uint8		*sdtp ;
-		uint16		pid ;
-		uint32		length ;
-		uint32		length2 ;
-		uint32		y ;
-		uint32		sectionlength ;
-		uint32		servicetype ;
-		uint32		audioservicetype ;
-		uint32		videoservicetype ;
-		uint32		prognumber ;
-		uint32		pmtpid ;
-		uint32		programcount ;
-		uint32		changedetected ;
-		uint8		rxbuff [256] ;
-	
-	(void) dummy ;
+		uint32		nowms ;
 
-	while (tsprocenabled == 0) 
+	nowms = monotime_ms() ;
+	pthread_mutex_lock (&vlcmutex) ;
+	if (strncmp (vlctitles[rx], title, VLCTITLESIZE - 1) || (nowms - vlctitletime[rx] >= VLCTITLEREFRESH))
 	{
-		usleep (100*1000) ;
+		if (vlctitlepending[rx])
+		{
+			vlctitlecoalesced++ ;
+		}
+		strncpy (vlctitles[rx], title, VLCTITLESIZE - 1) ;
+		vlctitles[rx][VLCTITLESIZE - 1] = 0 ;
+		vlctitlepending[rx] = 1 ;
+		vlctitletime[rx]    = nowms ;
+		pthread_cond_signal (&vlccond) ;
 	}
+	pthread_mutex_unlock (&vlcmutex) ;
+}
 
-	while (tsprocenabled == 1)
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 vlc_loop
+//@
+//@	 a thread to send the queued key presses and title bars to the VLC windows
+//@	 the commands are written to one shell which is kept open, so that a thread
+//@	 which queues them does not wait for a fork and exec of xdotool
+//@	 everything queued for one window is sent by one xdotool command
+//@
+//@	 Calling:
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+void* vlc_loop (void* dummy)
+{
+		uint32			n ;
+		uint32			rx ;
+		uint32			id ;
+		uint32			keycount ;
+		uint32			length ;
+		uint32			used ;
+		char*			src ;
+		FILE*			helper ;
+		struct vlckey	keys 		[VLCQUEUESIZE] ;
+		uint32			titlepending [MAXRECEIVERS+1] ;
+static	char			titles 		[MAXRECEIVERS+1][VLCTITLESIZE] ;
+static	char			command 	[(MAXRECEIVERS+1) * (VLCQUEUESIZE * 64 + VLCTITLESIZE * 4 + 64)] ;
+
+	(void) dummy ;
+
+	helper = 0 ;
+	pthread_mutex_lock (&vlcmutex) ;
+	while (vlcenabled == 1)
 	{
-			memset (rxbuff, 0, sizeof(rxbuff)) ;
-			status = read (whfd, (void*)rxbuff, 192) ;
-			if (status == 192)								// packet received
-			{
-				pp = (packetx_t*) rxbuff ;
-			}
-			else if ((status == -1) && (errno == 3))		// kernel driver is unloading
-			{
-				pp = 0 ;
-				printf ("<<Exiting %d>>\r\n",status) ;
-				usleep (5 * 1000 * 1000) ;
-				whexit (999) ;
-			}
-			else if ((status == -1) && (errno == 4))
+		used = vlckeycount ;
+		for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)
+		{
+			used |= vlctitlepending[rx] ;
+		}
+		if (used == 0)
+		{
+			pthread_cond_wait (&vlccond, &vlcmutex) ;
+			continue ;
+		}
+
+		keycount = vlckeycount ;											// take everything that is queued
+		memcpy (keys, vlckeys, keycount * sizeof(struct vlckey)) ;
+		vlckeycount = 0 ;
+		for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)
+		{
+			titlepending[rx] = vlctitlepending[rx] ;
+			if (titlepending[rx])
 			{
-				pp = 0 ;
-				printf ("<<Driver does not have spi5interruptnumber>>\r\n") ;
-				usleep (5 * 1000 * 1000) ;
-				whexit (986) ;
+				strcpy (titles[rx], vlctitles[rx]) ;
+				vlctitlepending[rx] = 0 ;
 			}
-			else if ((status == -1) && (errno == 5))
+		}
+		pthread_mutex_unlock (&vlcmutex) ;
+
+		length = 0 ;
+		for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)
+		{
+			id   = rcv[rx].xdotoolid ;
+			used = 0 ;
+			for (n = 0 ; n < keycount ; n++)
 			{
-				pp = 0 ;									// read timeout - normal behaviour
+				if ((keys[n].rx == rx) && id)
+				{
+					if (used == 0)
+					{
+						length += sprintf (&command[length], "xdotool") ;
+						used = 1 ;
+					}
+					if (keys[n].focus)
+					{
+						length += sprintf (&command[length], " windowfocus --sync %d", id) ;
+					}
+					length += sprintf (&command[length], " key --window %d %c", id, keys[n].key) ;
+				}
 			}
-			else if (status < 0)
+			if (titlepending[rx] && id)
 			{
-				printf ("[<%d %d>]\r\n",status,errno) ;
-				pp = 0 ;
-				continue ;
+				if (used == 0)
+				{
+					length += sprintf (&command[length], "xdotool") ;
+					used = 1 ;
+				}
+				length += sprintf (&command[length], " set_window --name '") ;
+				for (src = titles[rx] ; *src ; src++)								// quote the title for the shell
+				{
+					if (*src == '\'')
+					{
+						length += sprintf (&command[length], "'\\''") ;
+					}
+					else if ((uint8)*src < ' ')
+					{
+						command[length++] = ' ' ;								// keep it on one line
+					}
+					else
+					{
+						command[length++] = *src ;
+					}
+				}
+				length += sprintf (&command[length], "' %d", id) ;
 			}
-			else
+			if (used)
 			{
-				pp = 0 ;
+				length += sprintf (&command[length], "\n") ;
 			}
+		}
 
-			if (pp == 0)
+		if (length)
+		{
+			if (helper == 0)
 			{
-				continue ;
+				helper = popen ("/bin/sh", "w") ;
 			}
-
-			rx = pp->receiver + 1 ;										// receivers are numbered 0-3 in the PICs						
-																		// . . . and 1 to 4 in this program	
-			if 
-			(
-				(rcv[rx].active == 0) || 
-				(rcv[rx].scanstate != STATE_DEMOD_S && rcv[rx].scanstate != STATE_DEMOD_S2)) 
+			if (helper)
 			{
-			}
-	       	else if (pp->data[0] != 0x47)								// sync byte missing
-	       	{
-				rcv[rx].errors_sync++ ;		       						
-				rcv[rx].packetcountprogram++ ;							
-				rcv[rx].packetcountrx++ ;				
-				continue ;
-	       	}
-	       	else if (pp->valid)
-	       	{	       		       	
-				tempc = (pp->receiver & 2) + 1 ;						// rx1, rx3 <==> PIC_A or PIC_B 			
-				rcv[tempc].debug0 = pp->crc8 ;
-
-				tempu = pp->outsequence - rcv[tempc].outsequence ;		// 4 bit output sequence for each PIC
-				tempu &= 0xf ;
-				if (tempu != 1)
-				{
-					rcv[tempc].errors_outsequence ++ ;		       	
-					rcv[tempc].outsequence = pp->outsequence ;		       	
-				}
-				else
-				{
-					rcv[tempc].outsequence++ ;		       						
-				}
-				
-				tempu = pp->insequence - rcv[rx].insequence ;			// 4 bit input sequence for each receiver
-				tempu &= 0xf ;
-				if (tempu != 1)
+				if ((fwrite (command, 1, length, helper) != length) || fflush (helper))
 				{
-					rcv[rx].errors_insequence++ ;		       	
-					rcv[rx].insequence = pp->insequence ;
+					printf ("VLC control shell has stopped, restarting it\r\n") ;
+					pclose (helper) ;											// open it again next time
+					helper = 0 ;
 				}
 				else
 				{
-					rcv[rx].insequence++ ;
+					vlccommands++ ;
 				}
-
-				if (pp->restart)
-				{
-					rcv[rx].errors_restart++ ;
-				}
-				
-				pid = (pp->data[1] & 0x1f) * 0x100 + pp->data[2] ;
-				
-				rcv[rx].packetcountprogram++ ;				
-				rcv[rx].packetcountrx++ ;				
-				rcv[rx].packetcountprogram 		+= pp->nullpackets ;				
-				rcv[rx].packetcountrx      		+= pp->nullpackets ;				
-				rcv[rx].nullpacketcountprogram  += pp->nullpackets ;				
-				rcv[rx].nullpacketcountrx       += pp->nullpackets ;				
-				if (pid == NULL_PID || (pid == NULL2_PID && null8190))
-				{
-					rcv[rx].nullpacketcountprogram++ ;				
-					rcv[rx].nullpacketcountrx++ ;				
-				}
-
-			  	if ((rcv[rx].scanstate == STATE_DEMOD_S2) || (rcv[rx].scanstate == STATE_DEMOD_S))
-			  	{	
-			  		if (rcv[rx].tssock)
-			  		{
-						if (nullremove == 0)
-						{
-							if (rcv[rx].vlcstopped == 0)
-							{
-								for (x = 0 ; x < pp->nullpackets ; x++)
-								{
-						            status = sendto 
-				    		      	(
-   					    		       	rcv[rx].tssock, (char*)nullpacket, 188, 0,
-	       					    	   	(struct sockaddr*) &rcv[rx].tssockaddr, sizeof(rcv[rx].tssockaddr) 
-    	       						) ;
-								}
-							}
-						}						
-						rcv[rx].forbidden = 0 ;
-						
-						y = STATUS_VIDEO_TYPE ;
-						tempu = 0 ;											// don't send packet if true
-						if 
-						(									
-							(rx == 1) 								|| 
-							(rx <= h265max + 1) 					|| 
-							(modex == MODE_MULTICAST) 				||
-							(rcv[rx].iptype != IP_MYPC)				||
-							(rcv[rx].rawinfos[y] == SERVICE_H262) 	||
-							(rcv[rx].rawinfos[y] == SERVICE_H264)
-						)
-						{
-						}
-						else
-						{
-	    	           		if (rcv[rx].rawinfos[y])
-	    	           		{
-								rcv[rx].forbidden = 1 ;
-   	    	       			}
-							tempu++ ;										// don't send
-						}
-					
-						if (pid == EIT_PID && eitremove)					// EIT packet
-						{
-							tempu++ ;										// remove fromthe incoming TS
-						}
-					
-						if (pid == NULL_PID && nullremove)					// null packet
-						{
-							tempu++ ;										// don't send null packets
-						}
-					
-						if (pid == NULL2_PID && nullremove && null8190)		// fake null packet
-						{
-							tempu++ ;										// don't send fake null packets
-						}
-					
-						if (tempu == 0)
-						{
-							if (rcv[rx].vlcstopped == 0)
-							{
-					            status = sendto 
-			    		      	(
-			    		          	rcv[rx].tssock, (char*)pp, 188, 0,
-       					    	   	(struct sockaddr*) &rcv[rx].tssockaddr, sizeof(rcv[rx].tssockaddr) 
-   	       						) ;
-   	           					(void) status ;
-   	           				}
-   	           				rcv[rx].forbidden = 0 ; 
-   	           			}
-    	           		else if (rcv[rx].rawinfos[y])
-    	           		{
-							rcv[rx].forbidden = 1 ;
-    	           		}
-					
-// select the first PMT with program number > 0
-
-					if (pid == PAT_PID)
-					{
-						index = 5 ;
-						sectionlength = ((pp->data[index+1] & 0xf) << 8) + pp->data[index+2] ;
-						if (sectionlength <= 1 || sectionlength >= 188)
-						{
-							sectionlength = 0 ;
-						}
-						if (sectionlength)
-						{
-						    tempu = calculateCRC32 ((uint8*)&pp->data[index],sectionlength-1) ;
-							tempu = reverse (tempu) ;									// reverse byte order
-							index += sectionlength - 1 ;
-							if (tempu == *((uint32*)&pp->data[index]))					// CRC32 OK
-							{
-								pmtpid = 0 ; 											// PMT to use
-								programcount = 0 ;										// number of programs
-								index = 0x0d ;
-								while (index < 0x08 + sectionlength - 4)
-								{
-									prognumber = pp->data [index] * 0x100 + pp->data [index + 1] ;
-									index += 2 ;										// point to PMT pid
-									if (prognumber != 0) 
-									{ 
-										if ((rcv[rx].requestedprog == 0) || (prognumber == rcv[rx].requestedprog))									
-										{
-											if (pmtpid == 0)
-											{
-												pmtpid = (pp->data [index] & 0x1f) * 0x100 + pp->data [index + 1] ;
-										    }
-										}	
-								    	programcount++ ;
-									}
-									index += 2 ;
-								}
-								rcv[rx].pmtpid = pmtpid ;
-								rcv[rx].programcount = programcount ;
-							}
-						}
-					}
-
-// extract the video and audio service types from the PMT
-
-					else if ((pid == rcv[rx].pmtpid) && rcv[rx].pmtpid)					// the program we want
-					{	
-						index = 5 ;
-						sectionlength = ((pp->data[index+1] & 0xf) << 8) + pp->data[index+2] ;
-						if (sectionlength <= 1 || sectionlength >= 188)
-						{
-							sectionlength = 0 ;
-						}
-						audioservicetype = 0 ;
-						videoservicetype = 0 ;
-						servicetype      = 0 ;								
-						if (sectionlength)
-						{
-						    tempu = calculateCRC32 ((uint8*)&pp->data[index],sectionlength-1) ;
-							tempu = reverse (tempu) ;								// reverse byte order
-							index += sectionlength - 1 ;
-							if (tempu == *((uint32*)&pp->data[index]))				// CRC32 OK
-							{					
-								index = 0x0d ;										// point to first entry
-// get the PCR pid
-								tempu = (pp->data [index] & 0x1f) * 0x100 + pp->data [index + 1] ;
-								rcv[rx].pcrpid = tempu ;
-								index += 2 ;
-								tempu = (pp->data [index] & 0x0f) * 0x100 + pp->data [index + 1] ; // info length
-								index += tempu + 2 ;								// skip over the info										
-
-								audioservicetype = 0 ;
-								videoservicetype = 0 ;
-								servicetype      = 0 ;								
-
-// look for service types
-								while (index < 0x08 + sectionlength - 4)			
-								{							
-									servicetype = pp->data[index] ;					// H264, AAC etc	
-									index++ ;
-									index += 2 ;
-									tempu = (pp->data [index] & 0x0f) * 0x100 + pp->data [index + 1] ; // info length
-									index += tempu + 2 ;								// skip over the info																
-
-									switch (servicetype)
-									{
-										case SERVICE_H262:
-										case SERVICE_H264:
-										case SERVICE_H265:
-											videoservicetype = servicetype ;
-										break ;
-										case SERVICE_MPA:
-										case SERVICE_AAC:
-										case SERVICE_AC3:
-											audioservicetype = servicetype ;
-										break ;
-									}	
-								}
-
-
-
-
-							}							
-									
-							changedetected = 0 ;
-							y = STATUS_VIDEO_TYPE ;
-							if 
-							(
-								((int)videoservicetype != rcv[rx].rawinfos[y]) && 
-								videoservicetype
-							)
-							{
-								if (rcv[rx].rawinfos[y] != 0 || rcv[rx].vlcstopped)
-								{
-									 changedetected++ ;					
-								}			
-								rcv[rx].rawinfos[y] = videoservicetype ;
-								switch (videoservicetype)	
-								{					
-									case SERVICE_H262:
-										sprintf (rcv[rx].textinfos[y], "H262") ; break ;
-									break ;
-									case SERVICE_H264:
-										sprintf (rcv[rx].textinfos[y], "H264") ; break ;
-									break ;
-									case SERVICE_H265:
-										sprintf (rcv[rx].textinfos[y], "H265") ; break ;
-									break ;
-									default:
-										sprintf (rcv[rx].textinfos[y], "%s", "") ; break ;
-									break ;											
-								} ;
-							}
-
-							y = STATUS_AUDIO_TYPE ;
-							if 
-							(
-								((int)audioservicetype != rcv[rx].rawinfos[y]) && 
-								audioservicetype
-							)
-							{
-								if (rcv[rx].rawinfos[y] != 0 || rcv[rx].vlcstopped)
-								{
-									 changedetected++ ;					
-								}			
-								rcv[rx].rawinfos[y] = audioservicetype ;
-								switch (audioservicetype)
-								{
-									case SERVICE_MPA:
-										sprintf (rcv[rx].textinfos[y], "MPA") ; break ;
-									break ;
-									case SERVICE_AAC:
-										sprintf (rcv[rx].textinfos[y], "AAC") ; break ;
-									break ;
-									case SERVICE_AC3:
-										sprintf (rcv[rx].textinfos[y], "AC3") ; break ;
-									break ;
-									default:
-										sprintf (rcv[rx].textinfos[y], "%s", "") ; break ;
-									break ;
-								}					
-							}
-
-							if (changedetected)
-							{										
-							 	rcv[rx].vlcstopped = 0 ;
-								y = STATUS_VIDEO_TYPE ;
-								rcv[rx].rawinfos[y]= videoservicetype ;
-								y = STATUS_AUDIO_TYPE ;
-								rcv[rx].rawinfos[y] = audioservicetype ;
-								rcv[rx].modechanges++ ;							// count a mode change
-								rcv[rx].vlcnextcount++ ;
-								if (rcv[rx].xdotoolid)
-								{
-									sprintf (temps,	"xdotool key --window %d n", rcv[rx].xdotoolid) ;
-									system (temps) ;							// send NEXT to VLC
-								}
-							}
-						}
-					}
-					else if (pid == SDT_PID)								// service descriptor
-					{
-						index = 5 ;
-						sectionlength = ((pp->data[index+1] & 0xf) << 8) + pp->data[index+2] ;
-						if (sectionlength <= 1 || sectionlength >= 188)
-						{
-							sectionlength = 0 ;
-						}
-						if (sectionlength)
-						{
-						    tempu = calculateCRC32 ((uint8*)&pp->data[index],sectionlength-1) ;
-							tempu = reverse (tempu) ;							// reverse byte order
-							index += sectionlength - 1 ;
-							if (tempu == *((uint32*)&pp->data[index]))
-							{
-								sdtp = (uint8*) pp ;
-								sdtp += 16 ;									// point to the first entry
-								rcv[rx].serviceid  = *sdtp++ * 0x100 ;			// 16 bit service ID, high/low
-								rcv[rx].serviceid += *sdtp++ ;
-								sdtp += 3 ;										// point to the descriptor tag
-								if (*sdtp == 0x48)								// service descriptor
-								{					
-									sdtp += 3 ;									// point to the provider length
-									length = *sdtp++ ;							// provider length
-									if (length <=  15)
-									{
-										length2 = length ;
-									}
-										else
-									{
-										length2 = 15 ;
-									}
-									y = STATUS_SERVICE_PROVIDER_NAME ; 
-									strncpy (rcv[rx].textinfos[y], (void*)sdtp, length2) ; // copy the provider name
-									rcv[rx].textinfos[y][length2] = 0 ;			// terminate the string
-									sdtp += length ;							// point to the service name length 
-									length = *sdtp++ ;							// service name length 
-									if (length <=  15)
-									{
-										length2 = length ;
-									}
-										else
-									{
-										length2 = 15 ;
-									}
-									y = STATUS_SERVICE_NAME ; 					// callsign
-									if (rcv[rx].programcount != 1 && rcv[rx].textinfos[y][0])
-									{
-										strcpy (temps, "+") ;
-										strncat (temps, (void*)sdtp, length2) ; 	// copy the service name
-										temps [length2+1] = 0 ;						// terminate the string	
-									}
-									else
-									{
-										strcpy (temps, "") ;
-										strncat (temps, (void*)sdtp, length2) ; 	// copy the service name
-										temps [length2] = 0 ;						// terminate the string	
-									}
-									if (strcmp(temps,rcv[rx].textinfos[y]) != 0)
-									{
-										rcv[rx].modechanges++ ;					// count a mode change			
-										rcv[rx].packetcountrx  	   		= 0 ;	// clear packet count		
-										rcv[rx].nullpacketcountrx  		= 0 ;	// clear null packet count	
-									 	if (rcv[rx].textinfos[y][0] || rcv[rx].vlcstopped)
-									 	{
-											rcv[rx].vlcstopped = 0 ;
-											rcv[rx].vlcnextcount++ ;
-											rcv[rx].rawinfos[STATUS_VLCNEXTS] = rcv[rx].vlcnextcount ;
-											if (rcv[rx].xdotoolid) 
-											{
-												sprintf (temps2,	"xdotool key --window %d n", rcv[rx].xdotoolid) ;
-												system (temps2) ;					// send NEXT to VLC
-											}
-										}
-									}
-									strcpy (rcv[rx].textinfos[y], temps) ;	// copy the service name
-								}
-								sdtp += length ;								
-							}
-						}
-					}				
-		    	}		    	   
-			} 
+			}
 		}
+
+		pthread_mutex_lock (&vlcmutex) ;
 	}
+	pthread_mutex_unlock (&vlcmutex) ;
 
-	printf ("TSPROC thread exiting\r\n") ;
+	if (helper)
+	{
+		pclose (helper) ;
+	}
+	printf ("VLC control: %d commands, %d title bars coalesced, %d key presses dropped\r\n",
+		vlccommands, vlctitlecoalesced, vlckeydrops) ;
+	printf ("VLC    thread exiting\r\n") ;
 	return (0) ;
 }
 
@@ -3612,7 +7296,7 @@ void setup_titlebar (char *output, uint32 rx)
 		if (rcv[rx].scanstate == STATE_DEMOD_S2 || rcv[rx].scanstate == STATE_DEMOD_S)
 		{
 /*
-			sprintf (temps,"%0.3fM", (float)rcv[rx].frequencies[0] / 1000) ;
+			sprintf (temps,"%0.3fM", (float)rcv[rx].frequencies[rcv[rx].freqindex] / 1000) ;
 			pos = strstr (temps,".") ;
 			if (pos && (pos != temps))
 			{
@@ -3642,7 +7326,7 @@ void setup_titlebar (char *output, uint32 rx)
 		else
 		{
 			sprintf (output+strlen(output), " SR%d", rcv[rx].symbolrates[0]) ;
-			sprintf (output+strlen(output), " %0.3fMHz", (float)rcv[rx].frequencies[0] / 1000) ;
+			sprintf (output+strlen(output), " %0.3fMHz", (float)rcv[rx].frequencies[rcv[rx].freqindex] / 1000) ;
 		}
 		
 // display antenna
@@ -3959,56 +7643,6 @@ void juliandate (int32* julday, int32* julhour)
 }
 
 
-uint32 calculateCRC32 (uint8* data, uint32 dataLength)
-{
-    uint32      crc ;
-    uint32      poly, temp, temp2, temp4, bit31 ;
-	uint32		x ;
-
-	crc = 0xffffffff ;
-	poly = 0x04c11db7 ;
-
-   	while (dataLength-- > 0)
-	{
-		temp4 = poly ;
-		temp2 = (crc >> 24) ^ *data ;
-		temp = 0 ;
-
-		for (x = 0 ; x < 8 ; x++)
-		{
-			if ((temp2 >> x) & 1)
-			{
-				temp ^= temp4 ;
-			}
-
-			bit31 = temp4 >> 31 ;
-			temp4 <<= 1 ;
-			if (bit31)
-			{
-				temp4 ^= poly ;
-			}
-		}
-		crc = (crc<<8) ^ temp ;
-		data++ ;
-   	}
-    return crc ;
-}
-
-// reverse the byte order in a word
-
-uint32 reverse (uint32 indata)
-{
-	uint32		tempu ;
-
-	tempu  = 0 ;
-	tempu |= ((indata >> 24) & 0xff) <<  0 ;
-	tempu |= ((indata >> 16) & 0xff) <<  8 ;
-	tempu |= ((indata >>  8) & 0xff) << 16 ;
-	tempu |= ((indata >>  0) & 0xff) << 24 ;
-	
-	return (tempu) ;
-}
-
 void getdatetime (char *string)
 {
    	struct tm		mt ;
@@ -4050,6 +7684,10 @@ void whexit (int32 reason)
 	strcat (temps, ">>>>>>>>>>") ;
 	logit (temps) ;
 
+	printf ("\r\n") ;
+	i2c_print_stats () ;
+	i2cqueue_print_stats () ;
+	printf ("Register writes skipped: STV0910 %u, STV6120 %u\r\n", stv0910_writes_skipped, stv6120_writes_skipped) ;
 	printf ("\r\n") ;
 
 	usleep (3 * 1000 * 1000) ;
@@ -81,6 +81,28 @@
 #define STATUS_ANTENNA			  33		// 1:2 = TOP:BOT
 #define STATUS_AUDIO_TYPE		  34		// 0x03=MP2, 0x0f=AAC	
 
+// performance statistics; those for the whole system are reported as receiver 0
+
+#define STATUS_TS_READ_PACKETS	  40		// rx 0: average packets handled for each driver read or wakeup
+#define STATUS_TS_DGRAMS_PER_CALL 41		// average TS datagrams sent by each sendmmsg call
+#define STATUS_TS_DROPS			  42		// TS datagrams dropped because the socket buffers were full
+#define STATUS_PSI_HITS			  43		// PAT, PMT and SDT sections skipped because they had not changed
+#define STATUS_PSI_MISSES		  44		// PAT, PMT and SDT sections that were checked and parsed
+#define STATUS_I2C_ACCESSES		  45		// rx 0: I2C register accesses since the last info output
+#define STATUS_I2C_TIME			  46		// rx 0: average time for each of those accesses (us)
+#define STATUS_I2C_WAIT_TUNE	  47		// rx 0: average queueing delay of I2C tune requests since the last info output (us)
+#define STATUS_I2C_WAIT_INFO	  48		// rx 0: average queueing delay of I2C info requests since the last info output (us)
+#define STATUS_TUNE_TO_LOCK		  49		// time from the last tune request to lock (ms)
+#define STATUS_FAST_RETUNES		  50		// retunes which only changed the frequency, symbol rate or filter
+#define STATUS_TUNE_PROGRAMMED	  51		// time from the last tune request to the tuner and demodulator being set up (ms)
+#define STATUS_TUNE_TO_PACKET	  52		// time from the last tune request to the first TS packet being forwarded (ms)
+#define STATUS_SCAN_STEPS		  53		// steps taken by the current frequency / symbol rate scan
+#define STATUS_SCAN_TIME		  54		// time from the scan command to lock (ms); 0 while scanning
+#define STATUS_COMMAND_TO_TUNE	  55		// time from the last tune command arriving to the tuner and demodulator being set up (us)
+#define STATUS_TUNES_SUPERSEDED	  56		// tune and stop requests replaced by a newer one before being performed
+#define STATUS_TS_SUBSCRIBERS	  57		// extra TS destinations; the text lists each as ip:port datagrams sent/dropped
+#define STATUS_RING_OVERRUNS	  58		// rx 0: packets dropped by the driver because its ring was full; the text is PIC_A/PIC_B
+
 
 #define STATUS_TITLEBAR		  	  94		// text put into the VLC title bar
 
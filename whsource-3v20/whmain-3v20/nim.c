@@ -31,6 +31,7 @@
 /* -------------------------------------------------------------------------------------------------- */
 
 #include "globals.h"
+#include <time.h>
 
 /* -------------------------------------------------------------------------------------------------- */
 /* ----------------- GLOBALS and constants ---------------------------------------------------------- */
@@ -90,6 +91,10 @@ int32_t nim_init (uint8_t* nimexists, uint8_t* xlnaexists, uint8_t* chipid0910,
     uint8_t 	tempc ;
 	bool		tempo ;
 	bool		tempo2 ;
+	struct		timespec	inittime ;
+	struct		timespec	endtime ;
+	uint32_t	initus ;
+	uint32_t	initaccesses ;
 
 
 ///    printf("Flow: NIM init\r\n") ;
@@ -125,7 +130,14 @@ int32_t nim_init (uint8_t* nimexists, uint8_t* xlnaexists, uint8_t* chipid0910,
 			stvvglna_init (NIM_INPUT_BOTTOM, 1, &tempo2) ;		// check for external LNA		
 			*xlnaexists = (tempo << 1) | tempo2 ;
 		
+			stv6120_shadow_invalidate () ;						// nothing is known about the tuner registers yet
+			clock_gettime (CLOCK_MONOTONIC, &inittime) ;		// time the demodulator programming
+			initaccesses = i2caccesses ;
 			stv0910_init() ;									// set up the demodulators			
+			clock_gettime (CLOCK_MONOTONIC, &endtime) ;
+			initus  = (endtime.tv_sec - inittime.tv_sec) * 1000000 + (endtime.tv_nsec - inittime.tv_nsec) / 1000 ;
+			printf ("      Status: STV0910 init NIM_%c: %d.%03d ms, %d i2c transactions\r\n",
+					'@'+GLOBALNIM, initus / 1000, initus % 1000, i2caccesses - initaccesses) ;
 		}
 	}
 	
@@ -154,6 +166,27 @@ uint8_t nim_read_demod (uint16_t reg, uint8_t *val) {
     return (err) ;
 }
 
+/* -------------------------------------------------------------------------------------------------- */
+/* reads consecutive demodulator registers in one i2c transaction and takes care of the repeater     */
+/*    reg: the first demod register to read                                                           */
+/*      n: the number of registers to read                                                            */
+/*    buf: where to put the results                                                                   */
+/* return: error code                                                                                 */
+/* -------------------------------------------------------------------------------------------------- */
+
+uint8_t nim_read_demod_block (uint16_t reg, uint16_t n, uint8_t *buf) 
+{
+    uint8_t 	err	= ERROR_NONE ;
+
+
+	nim_set_stv0910_repeaters (false) ;													// turn off both repeaters
+	
+    if (err == ERROR_NONE) err = i2c_read_block16 (NIMI2CADDRESS[GLOBALNIM],reg,n,buf) ;
+    if (err != ERROR_NONE) printf ("ERROR: demod read 0x%.4x, %d bytes\r\n",reg,n) ;
+
+    return (err) ;
+}
+
 /* -------------------------------------------------------------------------------------------------- */
 /* writes to a demodulator register and takes care of the i2c bus repeater                            */
 /*    reg: which demod register to write to                                                           */
@@ -175,6 +208,28 @@ uint8_t nim_write_demod (uint16_t reg, uint8_t val)
 }
 
 
+/* -------------------------------------------------------------------------------------------------- */
+/* writes consecutive demodulator registers in one i2c transaction and takes care of the repeater    */
+/*    reg: the first demod register to write to                                                       */
+/*      n: the number of registers to write                                                           */
+/*    buf: the values to write                                                                        */
+/* return: error code                                                                                 */
+/* -------------------------------------------------------------------------------------------------- */
+
+uint8_t nim_write_demod_block (uint16_t reg, uint16_t n, uint8_t *buf) 
+{
+    uint8_t 	err = ERROR_NONE ;
+
+
+	nim_set_stv0910_repeaters (false) ;													// turn off both repeaters
+	
+    if (err == ERROR_NONE) err = i2c_write_block16 (NIMI2CADDRESS[GLOBALNIM],reg,n,buf) ;
+    if (err != ERROR_NONE) printf ("ERROR: demod write 0x%.4x, %d bytes\n",reg,n) ;
+
+    return (err) ;
+}
+
+
 /* -------------------------------------------------------------------------------------------------- */
 /* reads from the specified external lna taking care of the i2c bus repeater                          */
 /*  xlna_addr: i2c address of the external lna to access                                              */
@@ -51,7 +51,9 @@
 	uint8_t 	nim_read_tuner 				(uint8_t,  uint8_t*);
 	uint8_t 	nim_write_tuner				(uint8_t,  uint8_t );
 	uint8_t 	nim_read_demod 				(uint16_t, uint8_t*);
+	uint8_t 	nim_read_demod_block		(uint16_t, uint16_t, uint8_t*);
 	uint8_t 	nim_write_demod				(uint16_t, uint8_t );
+	uint8_t 	nim_write_demod_block		(uint16_t, uint16_t, uint8_t*);
 	uint8_t 	nim_read_xlna  				(uint8_t,  uint8_t, uint8_t*);
 	uint8_t 	nim_write_xlna 				(uint8_t,  uint8_t, uint8_t );
 	uint8_t 	nim_set_stv0910_repeaters 	(bool) ;
@@ -0,0 +1,330 @@
+// whreplay: off-board replay of the driver's packet interface
+//
+// packets are put into rings laid out as the driver's (see whring.h) and taken out by
+// tsproc_drain, the same code that tsproc_loop uses on the mapped rings, so the TS processing
+// and the sendmmsg output of winterhill-3v20 can be timed without the NIMs or the driver
+//
+// the packets are 192 byte packetx_t records: 188 byte TS packet + 4 byte PIC status word
+// they are read from a recording file if one is given, otherwise a stream for all 4 receivers
+// is made up, with a PAT on each every 200 packets
+// the UDP output goes to a local socket which is never read
+//
+// each pass takes the packets out after every 'batch' packets have arrived, where a batch of 1
+// is the one packet per read () of the original driver interface
+//
+// build and run with:	make whreplay && ./whreplay [recording [passes]]
+
+#define main winterhill_main						// the application's main () is not used
+#include "main.c"
+#undef main
+
+#define REPLAYPACKETS	200000						// packets made up when there is no recording
+#define REPLAYPATEVERY	200							// . . with a PAT on each receiver this often
+
+static	uint8				replayctl 	[WHRING_CONTROLSIZE] __attribute__ ((aligned (64))) ;
+static	uint8				replayrings [2 * WHRING_RINGSIZE] __attribute__ ((aligned (64))) ;
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 make up a stream of packets for all 4 receivers, as the PICs would send them
+//@
+//@	 Calling:	records		space for count records
+//@				count		number of records
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+static void replay_make (packetx_t* records, uint32 count)
+{
+		uint32			n ;
+		uint32			rx ;
+		uint32			crc ;
+		uint8*			dp ;
+		packetx_t*		pp ;
+		uint8			cc 			[4] ;
+		uint8			insequence 	[4] ;
+		uint8			outsequence [2] ;
+static	const uint8		pat [] =
+		{
+			0x00, 0xb0, 13,									// table id, section length
+			0x00, 0x01, 0xc1, 0x00, 0x00,					// transport stream id, version, section numbers
+			0x00, 0x01, 0xf0, 0x00							// program 1: PMT PID 0x1000
+		} ;
+
+	memset (records, 0, count * sizeof(packetx_t)) ;
+	memset (cc, 0, sizeof(cc)) ;
+	memset (insequence, 0, sizeof(insequence)) ;
+	memset (outsequence, 0, sizeof(outsequence)) ;
+
+	for (n = 0 ; n < count ; n++)
+	{
+		pp = &records [n] ;
+		rx = n & 3 ;
+		dp = pp->data ;
+		memset (dp, 0xff, sizeof(pp->data)) ;
+		dp [0] = 0x47 ;
+		if ((n / 4) % REPLAYPATEVERY == 0)
+		{
+			dp [1] = 0x40 ;											// PAT, payload unit start
+			dp [2] = 0x00 ;
+			dp [4] = 0 ;											// pointer field
+			memcpy (&dp [5], pat, sizeof(pat)) ;
+			crc = calculateCRC32 (&dp [5], sizeof(pat)) ;
+			dp [5 + sizeof(pat)]     = crc >> 24 ;
+			dp [5 + sizeof(pat) + 1] = crc >> 16 ;
+			dp [5 + sizeof(pat) + 2] = crc >> 8 ;
+			dp [5 + sizeof(pat) + 3] = crc ;
+		}
+		else if (n % 16 == 15)
+		{
+			dp [1] = 0x1f ;											// null packet
+			dp [2] = 0xff ;
+		}
+		else
+		{
+			dp [1] = 0x01 ;											// PID 0x100
+			dp [2] = 0x00 ;
+			memset (&dp [4], n, sizeof(pp->data) - 4) ;
+		}
+		dp [3] = 0x10 | (cc [rx]++ & 0x0f) ;
+
+		pp->valid 		= 1 ;
+		pp->receiver 	= rx ;
+		pp->insequence 	= ++insequence [rx] ;
+		pp->outsequence = ++outsequence [rx >> 1] ;
+	}
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 set up the receivers to send their TS to a local socket which is never read
+//@
+//@	 Calling:
+//@
+//@	 Return:	0 if done
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+static int32 replay_setup (void)
+{
+		uint32				rx ;
+		int					sink ;
+		int					sock ;
+		struct sockaddr_in	addr ;
+		socklen_t			length ;
+
+	sink = socket (AF_INET, SOCK_DGRAM, IPPROTO_UDP) ;
+	sock = socket (AF_INET, SOCK_DGRAM, IPPROTO_UDP) ;
+	if (sink < 0 || sock < 0)
+	{
+		return (-1) ;
+	}
+	memset (&addr, 0, sizeof(addr)) ;
+	addr.sin_family 	 = AF_INET ;
+	addr.sin_addr.s_addr = htonl (INADDR_LOOPBACK) ;
+	length = sizeof(addr) ;
+	if (bind (sink, (struct sockaddr*) &addr, sizeof(addr)) < 0 || getsockname (sink, (struct sockaddr*) &addr, &length) < 0)
+	{
+		return (-1) ;
+	}
+
+	memset ((void*)&rcv, 0, sizeof(rcv)) ;
+	crc32_init () ;
+	memset (nullpacket, 0xff, sizeof(nullpacket)) ;
+	nullpacket [0] = 0x47 ;
+	nullpacket [1] = 0x1f ;
+	nullpacket [2] = 0xff ;
+	nullpacket [3] = 0 ;
+	h265max 	= 1 ;
+	tsflushtime = 10 ;
+	for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)
+	{
+		rcv[rx].receiver 		= 1 ;
+		rcv[rx].active 			= 1 ;
+		rcv[rx].tsgate 			= 1 ;
+		rcv[rx].iptype 			= IP_MYNET ;
+		rcv[rx].tssock 			= sock ;
+		rcv[rx].tssockaddr 		= addr ;
+		rcv[rx].pidtablechanges = 1 ;
+	}
+
+	whctl 	= (struct whring_control*) replayctl ;
+	whrings = replayrings ;
+	return (0) ;
+}
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 replay the records through the rings, taking them out after every 'batch' packets
+//@
+//@	 Calling:	records		the packets
+//@				count		number of packets
+//@				passes		times to replay them
+//@				batch		packets put into the rings for each wakeup of the reader
+//@
+//@	 Return:
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+static void replay_run (packetx_t* records, uint32 count, uint32 passes, uint32 batch)
+{
+		uint32				n ;
+		uint32				p ;
+		uint32				rx ;
+		uint32				waiting ;
+		uint32				packets ;
+		uint32				wakeups ;
+		uint32				syscalls ;
+		uint32				datagrams ;
+		uint32				drops ;
+		uint32				errors ;
+		uint64_t			start ;
+		uint64_t			elapsed ;
+		packetx_t*			pp ;
+volatile uint32*			readyp ;
+		uint8*				ring ;
+
+	memset (replayctl, 0, sizeof(replayctl)) ;
+	for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)
+	{
+		rcv[rx].tssyscalls 	= 0 ;
+		rcv[rx].tsdatagrams = 0 ;
+		rcv[rx].tsdrops 	= 0 ;
+		rcv[rx].errors_sync = 0 ;
+	}
+
+	packets = 0 ;
+	wakeups = 0 ;
+	waiting = 0 ;
+	start 	= monotime_us () ;
+	for (p = 0 ; p < passes ; p++)
+	{
+		for (n = 0 ; n < count ; n++)
+		{
+			pp = &records [n] ;
+			if (pp->receiver & 2)											// receivers 3 and 4 are on PIC_B
+			{
+				readyp = &whctl->readyB ;
+				ring   = replayrings + WHRING_RINGSIZE ;
+				if (whring_count (whctl->readyB, whctl->fetchedB) >= WHRING_PACKETS)
+				{
+					packets += tsproc_drain () ;							// a full ring: the reader is late
+					wakeups++ ;
+					waiting  = 0 ;
+				}
+			}
+			else
+			{
+				readyp = &whctl->readyA ;
+				ring   = replayrings ;
+				if (whring_count (whctl->readyA, whctl->fetchedA) >= WHRING_PACKETS)
+				{
+					packets += tsproc_drain () ;
+					wakeups++ ;
+					waiting  = 0 ;
+				}
+			}
+			memcpy ((void*) whring_packet (ring, *readyp), pp, WHRING_PACKETSIZE) ;
+			__atomic_store_n (readyp, *readyp + 1, __ATOMIC_RELEASE) ;		// as the driver does
+
+			if (++waiting >= batch)
+			{
+				packets += tsproc_drain () ;
+				tsout_flush () ;
+				wakeups++ ;
+				waiting  = 0 ;
+			}
+		}
+	}
+	packets += tsproc_drain () ;
+	for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)
+	{
+		tsout_queue (rx) ;
+		tsout_send (rx) ;
+	}
+	elapsed = monotime_us () - start ;
+
+	syscalls  = 0 ;
+	datagrams = 0 ;
+	drops 	  = 0 ;
+	errors 	  = 0 ;
+	for (rx = 1 ; rx <= MAXRECEIVERS ; rx++)
+	{
+		syscalls  += rcv[rx].tssyscalls ;
+		datagrams += rcv[rx].tsdatagrams ;
+		drops 	  += rcv[rx].tsdrops ;
+		errors 	  += rcv[rx].errors_sync ;
+	}
+	printf ("batch %4u: %8u packets %8.1f ns/packet %8.1f packets/wakeup %6.1f datagrams/sendmmsg %u dropped %u sync errors\r\n",
+		batch, packets, (double) elapsed * 1000 / (packets ? packets : 1), (double) packets / (wakeups ? wakeups : 1),
+		(double) datagrams / (syscalls ? syscalls : 1), drops, errors) ;
+}
+
+
+int main (int argc, char* argv[])
+{
+		uint32			n ;
+		uint32			count ;
+		uint32			passes ;
+		long			size ;
+		FILE*			fp ;
+		packetx_t*		records ;
+static	const uint32	batches [] = {1, 8, 32, 128, 1024} ;
+
+	if (replay_setup () != 0)
+	{
+		printf ("Cannot open the UDP sockets\r\n") ;
+		return (1) ;
+	}
+
+	passes = argc > 2 ? atoi (argv[2]) : 1 ;
+	if (argc > 1)
+	{
+		fp = fopen (argv[1], "rb") ;
+		if (fp == 0)
+		{
+			printf ("Cannot open %s\r\n", argv[1]) ;
+			return (1) ;
+		}
+		fseek (fp, 0, SEEK_END) ;
+		size = ftell (fp) ;
+		fseek (fp, 0, SEEK_SET) ;
+		count 	= size / sizeof(packetx_t) ;
+		records = malloc (count * sizeof(packetx_t) + 1) ;
+		if (records == 0 || fread (records, sizeof(packetx_t), count, fp) != count)
+		{
+			printf ("Cannot read %s\r\n", argv[1]) ;
+			return (1) ;
+		}
+		fclose (fp) ;
+		printf ("%s: %u packets, %u passes\r\n", argv[1], count, passes) ;
+	}
+	else
+	{
+		count 	= REPLAYPACKETS ;
+		records = malloc (count * sizeof(packetx_t)) ;
+		if (records == 0)
+		{
+			return (1) ;
+		}
+		replay_make (records, count) ;
+		printf ("made up stream: %u packets, %u passes\r\n", count, passes) ;
+	}
+
+	for (n = 0 ; n < sizeof(batches) / sizeof(batches[0]) ; n++)
+	{
+		replay_run (records, count, passes, batches [n]) ;
+	}
+	free (records) ;
+	return (0) ;
+}
@@ -0,0 +1,120 @@
+// check of the packet ring helpers in whring.h, shared by whdriver-3v20 and winterhill-3v20
+//
+// the driver and the reader are simulated in one thread, in a random order, with the
+// free running counts started just below the 32 bit wrap
+// the writer drops a packet and counts an overrun when the ring is full, as the driver does
+//
+// build and run with:	make ringcheck && ./ringcheck
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef unsigned int			uint32 ;
+typedef unsigned char			uint8 ;
+
+#include "../whdriver-3v20/whring.h"
+
+#define STEPS		(64 * WHRING_PACKETS)
+
+static uint8					rxbuffers [WHRING_RINGSIZE] ;
+static struct whring_control	ctl ;
+
+
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@
+//@	 check the ring with the counts starting at a given value
+//@
+//@	 Calling:	start		initial value of the ready and fetched counts
+//@				bias		0-99: chance of the writer running at each step, in %
+//@
+//@	 Return:	number of errors
+//@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+//@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@@
+
+static uint32 ring_run (uint32 start, uint32 bias)
+{
+		uint32				n ;
+		uint32				errors ;
+		uint32				written ;
+		uint32				expected ;
+		uint32				value ;
+		uint32				seen ;
+		uint8*				pp ;
+
+	memset (&ctl, 0, sizeof(ctl)) ;
+	ctl.readyA   = start ;
+	ctl.fetchedA = start ;
+	errors 	 = 0 ;
+	written  = 0 ;
+	expected = 0 ;
+	seen 	 = 0 ;
+
+	for (n = 0 ; n < STEPS ; n++)
+	{
+		if ((uint32) (rand () % 100) < bias)								// the driver
+		{
+			if (whring_count (ctl.readyA, ctl.fetchedA) < WHRING_PACKETS)
+			{
+				pp = (uint8*) whring_packet (rxbuffers, ctl.readyA) ;
+				memcpy (pp, &written, sizeof(written)) ;
+				memset (pp + sizeof(written), written & 0xff, WHRING_PACKETSIZE - sizeof(written)) ;
+				ctl.readyA++ ;
+			}
+			else
+			{
+				ctl.overrunsA++ ;
+			}
+			written++ ;
+		}
+		else if (whring_count (ctl.readyA, ctl.fetchedA))					// the reader
+		{
+			pp = (uint8*) whring_packet (rxbuffers, ctl.fetchedA) ;
+			memcpy (&value, pp, sizeof(value)) ;
+			if (value < expected || pp [WHRING_PACKETSIZE - 1] != (value & 0xff))
+			{
+				printf ("start %08x: packet %u read after %u\r\n", start, value, expected) ;
+				errors++ ;
+			}
+			expected = value + 1 ;
+			seen++ ;
+			ctl.fetchedA++ ;
+		}
+
+		if (whring_count (ctl.readyA, ctl.fetchedA) > WHRING_PACKETS)
+		{
+			printf ("start %08x: %u packets in the ring\r\n", start, whring_count (ctl.readyA, ctl.fetchedA)) ;
+			errors++ ;
+		}
+	}
+
+	seen += whring_count (ctl.readyA, ctl.fetchedA) ;
+	if (seen + ctl.overrunsA != written)
+	{
+		printf ("start %08x: %u written, %u read or waiting, %u overruns\r\n", start, written, seen, ctl.overrunsA) ;
+		errors++ ;
+	}
+	printf ("start %08x  writer %2u%%: %8u written %8u overruns %s\r\n",
+		start, bias, written, ctl.overrunsA, errors ? "FAIL" : "ok") ;
+	return (errors) ;
+}
+
+
+int main (void)
+{
+		uint32		errors ;
+
+	srand (1) ;
+	errors  = 0 ;
+	errors += ring_run (0, 50) ;
+	errors += ring_run (0xffffffff - WHRING_PACKETS / 2, 50) ;			// the counts wrap while running
+	errors += ring_run (0xffffffff - WHRING_PACKETS / 2, 90) ;			// . . and the ring fills up
+	errors += ring_run (0xffffffff, 99) ;
+	errors += ring_run (0x80000000 - 1, 10) ;
+
+	printf ("%s\r\n", errors ? "RING CHECK FAILED" : "ring check passed") ;
+	return (errors ? 1 : 0) ;
+}
@@ -62,7 +62,9 @@ I2C addresses need to be shifted right for /dev/i2c-1
 #include <string.h>				
 #include <fcntl.h>
 #include <errno.h>
+#include <time.h>
 #include <sys/ioctl.h>
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
 
 /* -------------------------------------------------------------------------------------------------- */
@@ -70,11 +72,15 @@ I2C addresses need to be shifted right for /dev/i2c-1
 /* -------------------------------------------------------------------------------------------------- */
 
 
-static	int			i2cfd ;									// file descriptor for i2C
+static	int			i2cfd = -1 ;							// file descriptor for i2C, opened once
 static	char		i2cname 	  [] = {"/dev/i2c-1"} ;		// system file name for I2C		 
 
 		uint8_t     NIMI2CADDRESS [] = {0,NIM_DEMOD_ADDR_A,NIM_DEMOD_ADDR_B} ;
 
+		uint32_t	i2caccesses ;							// number of register accesses
+		uint64_t	i2caccesstime ;							// total time taken by them (us)
+		uint32_t	i2chistogram  [I2CHISTOGRAMBINS] ;		// number of accesses by time taken
+
 
 
 /* -------------------------------------------------------------------------------------------------- */
@@ -82,6 +88,119 @@ static	char		i2cname 	  [] = {"/dev/i2c-1"} ;		// system file name for I2C
 /* -------------------------------------------------------------------------------------------------- */
 
 
+/* -------------------------------------------------------------------------------------------------- */
+/* open the i2c bus, if it is not already open; it is then kept open                                  */
+/* return: error code                                                                                 */
+/* -------------------------------------------------------------------------------------------------- */
+
+static int i2c_open (void)
+{
+	if (i2cfd < 0)
+	{
+		i2cfd = open (i2cname,O_RDWR) ;							
+	    if (i2cfd < 0)
+	    {
+	        printf ("Error@: Cannot open %s (%s)\r\n",i2cname,strerror(errno)) ;
+	        return (errno) ;
+	    }
+	}
+	return (0) ;
+}
+
+/* -------------------------------------------------------------------------------------------------- */
+/* use a file descriptor that is already open instead of /dev/i2c-1, e.g. the i2csim simulated bus    */
+/*     fd: the file descriptor                                                                        */
+/* -------------------------------------------------------------------------------------------------- */
+
+void i2c_use_fd (int fd)
+{
+	if (i2cfd >= 0)
+	{
+		close (i2cfd) ;
+	}
+	i2cfd = fd ;
+}
+
+/* -------------------------------------------------------------------------------------------------- */
+/* do one i2c transaction: a write, optionally followed by a read after a repeated start              */
+/*   addr: the i2c bus address to access                                                              */
+/*  wbuff: the bytes to write                                                                         */
+/*   wlen: the number of bytes to write                                                               */
+/*  rbuff: where to put the bytes read                                                                */
+/*   rlen: the number of bytes to read; 0 for a write only                                            */
+/* return: error code                                                                                 */
+/* -------------------------------------------------------------------------------------------------- */
+
+static int i2c_transfer (uint8_t addr, uint8_t *wbuff, uint16_t wlen, uint8_t *rbuff, uint16_t rlen)
+{
+	int							err ;
+	int							bin ;
+	uint32_t					us ;
+	struct i2c_msg				msgs [2] ;
+	struct i2c_rdwr_ioctl_data	rdwr ;
+	struct timespec				start ;
+	struct timespec				end ;
+
+	err = i2c_open () ;
+	if (err)
+	{
+		return (err) ;
+	}
+
+	msgs[0].addr  = addr >> 1 ;								// slave addresses are 7 bit for /dev/i2c-1		
+	msgs[0].flags = 0 ;
+	msgs[0].len   = wlen ;
+	msgs[0].buf   = wbuff ;
+	msgs[1].addr  = addr >> 1 ;
+	msgs[1].flags = I2C_M_RD ;
+	msgs[1].len   = rlen ;
+	msgs[1].buf   = rbuff ;
+	rdwr.msgs     = msgs ;
+	rdwr.nmsgs    = rlen ? 2 : 1 ;
+
+	clock_gettime (CLOCK_MONOTONIC, &start) ;
+	err = ioctl (i2cfd, I2C_RDWR, &rdwr) ;
+	clock_gettime (CLOCK_MONOTONIC, &end) ;
+	if (err < 0)
+	{
+		return (errno) ;
+	}
+
+	us  = (end.tv_sec - start.tv_sec) * 1000000 + (end.tv_nsec - start.tv_nsec) / 1000 ;
+	i2caccesses++ ;
+	i2caccesstime += us ;
+	bin = 0 ;
+	us >>= 5 ;												// bin 0 is < 32us
+	while (us && bin < I2CHISTOGRAMBINS - 1)
+	{
+		us >>= 1 ;
+		bin++ ;
+	}
+	i2chistogram [bin]++ ;
+
+	return (0) ;
+}
+
+/* -------------------------------------------------------------------------------------------------- */
+/* print the number of register accesses and the histogram of the time they took                     */
+/* -------------------------------------------------------------------------------------------------- */
+
+void i2c_print_stats (void)
+{
+	int			bin ;
+
+	printf ("I2C accesses: %u, average %llu us\r\n", i2caccesses, 
+		(unsigned long long) (i2caccesses ? i2caccesstime / i2caccesses : 0)) ;
+	for (bin = 0 ; bin < I2CHISTOGRAMBINS ; bin++)
+	{
+		if (i2chistogram [bin])
+		{
+			printf ("    %s %6u us: %u\r\n", bin < I2CHISTOGRAMBINS - 1 ? "<" : ">=", 
+				32 << (bin < I2CHISTOGRAMBINS - 1 ? bin : bin - 1), i2chistogram [bin]) ;
+		}
+	}
+}
+
 /* -------------------------------------------------------------------------------------------------- */
 /* read an i2c 16 bit register from the nim   													      */
 /*																									  */	
@@ -95,50 +214,42 @@ uint8_t i2c_read_reg16 (uint8_t addr, uint16_t reg, uint8_t *val)
 {
     int err ;
 
-	char		buff [8] ;									
+	uint8_t		buff [8] ;									
 
 ///	printf ("i2c: %02X %04X\r\n",addr,reg) ; ///////////////	    
 
-	i2cfd = open (i2cname,O_RDWR) ;							
-    if (i2cfd < 0)
-    {
-        printf ("Error@: Cannot open %s (%s)\r\n",i2cname,strerror(errno)) ;
-        err = errno ;
-    }
-	else													// check for slave presence
+	buff [0] = (reg >> 8) & 0xff ;							// register address, then read the byte
+	buff [1] = (reg >> 0) & 0xff ;
+	err = i2c_transfer (addr, buff, 2, val, 1) ;
+	if (err)
 	{
-		err = ioctl (i2cfd, I2C_SLAVE, addr >> 1) ;			// slave addresses are 7 bit for /dev/i2c-1		
-		if (err < 0)
-		{
-			printf ("Error@: Cannot open I2C slave 0x%02X (%s)\r\n",addr,strerror(errno)) ;
-			err = errno ;
-		}
-		else
-		{
-			buff [0] = (reg >> 8) & 0xff ;
-			buff [1] = (reg >> 0) & 0xff ;
-			err = write (i2cfd,buff,2) ;					// first send the register address
-			if (err < 0)
-			{
-				printf ("Error@: Cannot set register address on device 0x%02X register 0x%04X (%s)\r\n",addr,reg,strerror(errno)) ;
-				err = errno ;
-			}
-			else
-			{
-				err = read (i2cfd,buff,1) ;					// now read the byte
-				if (err < 0)
-				{
-					printf ("Error@: Cannot read byte from device 0x%02X (%s)\r\n",addr,strerror(errno)) ;
-					err = errno ;
-				}
-				else
-				{
-					err = 0 ;
-					*val = (uint8_t) (buff[0]) ;
-				}
-			}
-		}
-		close (i2cfd) ;
+		printf ("Error@: Cannot read byte from device 0x%02X register 0x%04X (%s)\r\n",addr,reg,strerror(err)) ;
+	}
+
+    return (err) ;
+} 
+
+/* -------------------------------------------------------------------------------------------------- */
+/* read consecutive 16 bit address i2c registers in one transaction; the address auto-increments      */
+/*   addr: the i2c bus address to access                                                              */
+/*    reg: the first register to read                                                                 */
+/*      n: the number of registers to read                                                            */
+/*   *val: where to put the values read                                                               */
+/* return: error code                                                                                 */
+/* -------------------------------------------------------------------------------------------------- */
+
+uint8_t i2c_read_block16 (uint8_t addr, uint16_t reg, uint16_t n, uint8_t *val) 
+{
+    int err ;
+
+	uint8_t		buff [8] ;									
+
+	buff [0] = (reg >> 8) & 0xff ;							// register address, then read the bytes
+	buff [1] = (reg >> 0) & 0xff ;
+	err = i2c_transfer (addr, buff, 2, val, n) ;
+	if (err)
+	{
+		printf ("Error@: Cannot read %d bytes from device 0x%02X register 0x%04X (%s)\r\n",n,addr,reg,strerror(err)) ;
 	}
 
     return (err) ;
@@ -156,42 +267,49 @@ uint8_t i2c_write_reg16 (uint8_t addr, uint16_t reg, uint8_t val)
 {
     int err;
     
-	char		buff [8] ;								
+	uint8_t		buff [8] ;								
 
 ///	printf ("i2c: %02X %04X %02X\r\n",addr,reg,val) ; ///////////////	    
 
-	i2cfd = open (i2cname,O_RDWR) ;						
-    if (i2cfd < 0)
-    {
-        printf ("Error@: Cannot open %s (%s)\r\n",i2cname,strerror(errno)) ;
-        err = errno ;
-    }
-	else													// check for slave presence
+	buff [0] = (reg >> 8) & 0xff ;
+	buff [1] = (reg >> 0) & 0xff ;
+	buff [2] = val ;
+	err = i2c_transfer (addr, buff, 3, NULL, 0) ;
+	if (err)
 	{
-		err = ioctl (i2cfd, I2C_SLAVE, addr >> 1) ;			// slave addresses are 7 bit for /dev/i2c-1		
-		if (err < 0)
-		{
-			printf ("Error@: Cannot open I2C slave 0x%02X (%s)\r\n",addr,strerror(errno)) ;
-			close (i2cfd) ;
-			err = errno ;
-		}
-		else
-		{
-			buff [0] = (reg >> 8) & 0xff ;
-			buff [1] = (reg >> 0) & 0xff ;
-			buff [2] = val ;
-			err = write (i2cfd,buff,3) ;
-			if (err < 0)
-			{
-				printf ("Error@: Cannot write byte to device 0x%02X register 0x%02X (%s)\r\n",addr,reg,strerror(errno)) ;
-				err = errno ;
-			}
-			else
-			{
-				err = 0 ;
-			}
-			close (i2cfd) ;
-		}
+		printf ("Error@: Cannot write byte to device 0x%02X register 0x%04X (%s)\r\n",addr,reg,strerror(err)) ;
+	}
+
+    return (err) ;
+}
+
+/* -------------------------------------------------------------------------------------------------- */
+/* write consecutive 16 bit i2c registers in one transaction, using the device's auto increment       */
+/*   addr: the i2c bus address to access                                                              */
+/*    reg: the first register to write to                                                             */
+/*      n: the number of registers to write, up to I2CMAXBURST                                       */
+/*   *val: the values to write                                                                        */
+/* return: error code                                                                                 */
+/* -------------------------------------------------------------------------------------------------- */
+
+uint8_t i2c_write_block16 (uint8_t addr, uint16_t reg, uint16_t n, uint8_t *val) 
+{
+    int err;
+    
+	uint8_t		buff [I2CMAXBURST + 2] ;								
+
+	if (n > I2CMAXBURST)
+	{
+		return (EINVAL) ;
+	}
+
+	buff [0] = (reg >> 8) & 0xff ;
+	buff [1] = (reg >> 0) & 0xff ;
+	memcpy (&buff [2], val, n) ;
+	err = i2c_transfer (addr, buff, n + 2, NULL, 0) ;
+	if (err)
+	{
+		printf ("Error@: Cannot write %d bytes to device 0x%02X register 0x%04X (%s)\r\n",n,addr,reg,strerror(err)) ;
 	}
 
     return (err) ;
@@ -207,55 +325,15 @@ uint8_t i2c_write_reg16 (uint8_t addr, uint16_t reg, uint8_t val)
 
 uint8_t i2c_read_reg8 (uint8_t addr, uint8_t reg, uint8_t *val) 
 {
-///    uint8_t err;											
-
-	char		buff [8] ;									
+	uint8_t		buff [8] ;									
 	int			err ;											
 
 ///	printf ("i2c: %02X %02X\r\n",addr,reg) ; ///////////////	    
 
-	i2cfd = open (i2cname,O_RDWR) ;							
-    if (i2cfd < 0)
-    {
-        printf ("Error@: Cannot open %s (%s)\r\n",i2cname,strerror(errno)) ;
-        err = errno ;
-    }
-	else													// check for slave presence
-	{
-		err = ioctl (i2cfd, I2C_SLAVE, addr >> 1) ;			// slave addresses are 7 bit for /dev/i2c-1		
-		if (err < 0)
-		{
-			printf ("Error@: Cannot open I2C slave 0x%02X (%s)\r\n",addr,strerror(errno)) ;
-			err = errno ;
-		}
-		else
-		{
-			buff [0] = reg ;
-			err = write (i2cfd,buff,1) ;					// first send the register address
-			if (err < 0)
-			{
-				printf ("Error@: Cannot set register address on device 0x%02X register 0x%04X (%s)\r\n",addr,reg,strerror(errno)) ;
-				err = errno ;
-			}
-			else
-			{
-				err = read (i2cfd,buff,1) ;					// now read the byte
-				if (err < 0)
-				{
-					printf ("Error@: Cannot read byte from device 0x%02X (%s)\r\n",addr,strerror(errno)) ;
-					err = errno ;
-				}
-				else
-				{
-					err = 0 ;
-					*val = (uint8_t) (buff[0]) ;
-				}
-			}
-		}
-		close (i2cfd) ;
-	}
+	buff [0] = reg ;										// register address, then read the byte
+	err = i2c_transfer (addr, buff, 1, val, 1) ;
 
-    if (err!=ERROR_NONE) printf("ERROR: i2c read reg8 0x%.2x, 0x%.2x\n",addr,reg);
+    if (err!=ERROR_NONE) printf("ERROR: i2c read reg8 0x%.2x, 0x%.2x (%s)\n",addr,reg,strerror(err));
 
     return err;
 }
@@ -273,46 +351,15 @@ uint8_t i2c_write_reg8 (uint8_t i2caddr, uint8_t reg, uint8_t val)
 {
     int err ;
 
-	char		buff [8] ;									
+	uint8_t		buff [8] ;									
 
 ///	printf ("i2c: %02X %02X %02X\r\n",addr,reg,val) ; ///////////////	    
 
-	i2cfd = open (i2cname,O_RDWR) ;							
-    if (i2cfd < 0)
-    {
-        printf ("Error@: Cannot open %s (%s)\r\n",i2cname,strerror(errno)) ;
-        err = errno ;
-    }
-	else													// check for slave presence
-	{
-		err = ioctl (i2cfd, I2C_SLAVE, i2caddr >> 1) ;			// slave addresses are 7 bit for /dev/i2c-1		
-		if (err < 0)
-		{
-			printf ("Error@: Cannot open I2C slave 0x%02X (%s)\r\n",i2caddr,strerror(errno)) ;
-			close (i2cfd) ;
-			err = errno ;
-		}
-		else
-		{
-			buff [0] = reg ;
-			buff [1] = val ;
-			err = write (i2cfd,buff,2) ;
-			if (err < 0)
-			{
-				printf ("Error@: Cannot write byte to device 0x%02X register 0x%02X (%s)\r\n",i2caddr,reg,strerror(errno)) ;
-				err = errno ;
-			}
-			else
-			{
-				err = 0 ;
-			}
-			close (i2cfd) ;
-		}
-	}
-
-    return (err) ;
+	buff [0] = reg ;
+	buff [1] = val ;
+	err = i2c_transfer (i2caddr, buff, 2, NULL, 0) ;
 
-    if (err!=ERROR_NONE) printf("ERROR: i2c_write reg8 0x%.2x, 0x%.2x, 0x%.2x\n",i2caddr,reg,val);
+    if (err!=ERROR_NONE) printf("ERROR: i2c_write reg8 0x%.2x, 0x%.2x, 0x%.2x (%s)\n",i2caddr,reg,val,strerror(err));
 
     return err;
 }
@@ -67,10 +67,27 @@
 	#define NIM_LNA_0_ADDR 		STVVGLNA_I2C_ADDR3
 	#define NIM_LNA_1_ADDR 		STVVGLNA_I2C_ADDR0
 	
+// maximum number of registers written in one burst
+
+	#define I2CMAXBURST			64
+
+// register access statistics
+
+	#define I2CHISTOGRAMBINS	12						// bin 0 is < 32us, then doubling; the last is >= 32ms
+
+	extern uint32_t		i2caccesses ;
+	extern uint64_t		i2caccesstime ;
+	extern uint32_t		i2chistogram [I2CHISTOGRAMBINS] ;
+
+	void	i2c_print_stats		(void) ;
+	void	i2c_use_fd			(int) ;
+
 	uint8_t i2c_read_reg8 		(uint8_t, uint8_t   reg, uint8_t*) ;
 	uint8_t i2c_read_reg16 		(uint8_t, uint16_t  reg, uint8_t*) ;
+	uint8_t i2c_read_block16	(uint8_t, uint16_t  reg, uint16_t, uint8_t*) ;
 	uint8_t i2c_write_reg8 		(uint8_t, uint8_t   reg, uint8_t)  ;
 	uint8_t i2c_write_reg16		(uint8_t, uint16_t  reg, uint8_t)  ;
+	uint8_t i2c_write_block16	(uint8_t, uint16_t  reg, uint16_t, uint8_t*) ;
 
 	uint8_t i2c_write_pic16		(uint8_t, uint8_t   reg, uint8_t, uint8_t)  ;
 	uint8_t i2c_write_pic8		(uint8_t, uint8_t,  uint8_t) ;
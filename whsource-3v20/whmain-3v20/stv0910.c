@@ -113,6 +113,39 @@ uint8_t stv0910_setup_receive (uint32_t tunerdemod, uint32_t sr, int32_t calibra
     return (err) ;
 }
 
+/* -------------------------------------------------------------------------------------------------- */
+/* retunes a demodulator which has already been set up by stv0910_setup_receive                       */
+/* the demodulator is stopped, and the carrier and timing loops are only set up again if the symbol  */
+/* rate or the calibration has changed; the equalisers are left alone                                */
+/*   tunerdemod: 	the  tuner/demod combination (1 or 2)								           	  */
+/*   sr: 			the symbol rate                                                                   */
+/* 	 calibrated:	the rx has been calibrated for QO100                                              */
+/*   loops:			set up the carrier and timing loops                                               */
+/* return: error code                                                                                 */
+/* -------------------------------------------------------------------------------------------------- */
+
+uint8_t stv0910_retune_receive (uint32_t tunerdemod, uint32_t sr, int32_t calibrated, bool loops) 
+{
+    uint8_t 	err = ERROR_NONE ; 
+
+    printf ("Flow: STV0910 retune\r\n") ;
+
+    err = stv0910_write_reg 
+    (
+    	tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_DMDISTATE : RSTV0910_P1_DMDISTATE, 0x1c
+	) ;
+
+	if (loops)
+	{
+	    if (err == ERROR_NONE) err = stv0910_setup_carrier_loop (tunerdemod, sr, calibrated) ;
+    	if (err == ERROR_NONE) err = stv0910_setup_timing_loop  (tunerdemod, sr) ;
+	}
+
+    if (err != ERROR_NONE) printf ("ERROR: STV0910_retune_receive \r\n") ;
+
+    return (err) ;
+}
+
 /* -------------------------------------------------------------------------------------------------- */
 /* read Rolloff																					  	  */
 /*   return: error state                                                                              */
@@ -144,14 +177,17 @@ uint8_t stv0910_read_multistream0 (uint8_t tunerdemod, uint32_t *info)
 			uint8_t		temp1 ;
 			uint8_t		temp2 ;		
 			uint8_t		temp3 ;
+			uint8_t		buff [2] ;
 	static	uint8_t		modex ;		// cycles around 0,1,2 to get current,lowest,highest stream number
 
 	err = ERROR_NONE ;
 
-    err |= stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_MATSTR0   : RSTV0910_P1_MATSTR0,   &temp0) ; 
-    err |= stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_MATSTR1   : RSTV0910_P1_MATSTR1,   &temp1) ; 
-    err |= stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_PDELCTRL0 : RSTV0910_P1_PDELCTRL0, &temp2) ; 
-    err |= stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_PDELCTRL1 : RSTV0910_P1_PDELCTRL1, &temp3) ; 
+    err |= stv0910_read_regs (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_MATSTR1   : RSTV0910_P1_MATSTR1,   2, buff) ; 	// MATSTR1, MATSTR0
+	temp1 = buff [0] ;
+	temp0 = buff [1] ;
+    err |= stv0910_read_regs (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_PDELCTRL0 : RSTV0910_P1_PDELCTRL0, 2, buff) ; 	// PDELCTRL0, PDELCTRL1
+	temp2 = buff [0] ;
+	temp3 = buff [1] ;
 
 	*info = temp0 | (temp1 << 8) | (temp2 << 16) | (temp3 << 24) ;
 
@@ -175,15 +211,13 @@ uint8_t stv0910_read_multistream0 (uint8_t tunerdemod, uint32_t *info)
 uint8_t stv0910_read_multistream1 (uint8_t tunerdemod, uint32_t *info)		// (!~!~!) 					
 {
 			uint8_t		err ;
-			uint8_t		temp0 ;		
-			uint8_t		temp1 ;
+			uint8_t		buff [2] ;
 
 	err = ERROR_NONE ;
 
-    err |= stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_ISIENTRY  : RSTV0910_P1_ISIENTRY,  &temp0) ; 
-    err |= stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_ISIBITENA : RSTV0910_P1_ISIBITENA, &temp1) ; 
+    err |= stv0910_read_regs (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_ISIENTRY  : RSTV0910_P1_ISIENTRY, 2, buff) ;	// ISIENTRY, ISIBITENA 
 
-	*info = temp0 | (temp1 << 8) ;
+	*info = buff [0] | (buff [1] << 8) ;
     if (err != ERROR_NONE) printf ("ERROR: STV0910 read multistream1\r\n") ;
 
 	return (err) ;
@@ -197,15 +231,13 @@ uint8_t stv0910_read_multistream1 (uint8_t tunerdemod, uint32_t *info)		// (!~!~
 uint8_t stv0910_read_debug0 (uint8_t tunerdemod, uint32_t *info)		// (!~!~!) 					
 {
 			uint8_t		err ;
-			uint8_t		temp0 ;		
-			uint8_t		temp1 ;
+			uint8_t		buff [2] ;
 
 	err = ERROR_NONE ;
 
-    err |= stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_TSSTATUS : RSTV0910_P1_TSSTATUS,  &temp0) ; 
-    err |= stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_TSSTATUS2: RSTV0910_P1_TSSTATUS2, &temp1) ; 
+    err |= stv0910_read_regs (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_TSSTATUS : RSTV0910_P1_TSSTATUS, 2, buff) ;	// TSSTATUS, TSSTATUS2 
 
-	*info = temp0 | (temp1 << 8) ;
+	*info = buff [0] | (buff [1] << 8) ;
 
     if (err != ERROR_NONE) printf ("ERROR: STV0910 read multistream0\r\n") ;
 
@@ -299,20 +331,15 @@ uint8_t stv0910_read_car_freq(uint8_t tunerdemod, int32_t *cf)
 {
     uint8_t 	err = ERROR_NONE ;
     uint8_t 	val_h, val_m, val_l ;
+    uint8_t		buff [3] ;
     double 		car_offset_freq;
 
-/* first off we read in the carrier offset as a signed number */
+/* first off we read in the carrier offset as a signed number; CFR2, CFR1, CFR0 are read together */
 
-    err = stv0910_read_reg(tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_CFR2 : RSTV0910_P1_CFR2, &val_h) ; 		/* high byte*/
-    if (err == ERROR_NONE) 
-	{
-		err = stv0910_read_reg(tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_CFR1 : RSTV0910_P1_CFR1, &val_m) ; 	/* mid */
-	}
-	
-    if (err == ERROR_NONE) 
-	{
-		err = stv0910_read_reg(tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_CFR0 : RSTV0910_P1_CFR0, &val_l) ; 	/* low */
-	}
+    err = stv0910_read_regs(tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_CFR2 : RSTV0910_P1_CFR2, 3, buff) ;
+    val_h = buff [0] ;																						/* high byte*/
+    val_m = buff [1] ;																						/* mid */
+    val_l = buff [2] ;																						/* low */
 	
 /* 
 	since this is a 24 bit signed value, we need to build it as a 24 bit value, shift it up to the top
@@ -345,13 +372,11 @@ uint8_t stv0910_read_car_freq(uint8_t tunerdemod, int32_t *cf)
 uint8_t stv0910_read_constellation(uint8_t tunerdemod, uint8_t *i, uint8_t *q) {
 
     uint8_t 	err = ERROR_NONE ;
+    uint8_t		buff [2] ;
 
-    err = stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_ISYMB : RSTV0910_P1_ISYMB, i) ;
-    
-	if (err == ERROR_NONE) 
-	{
-		err = stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_QSYMB : RSTV0910_P1_QSYMB, q) ;
-	}
+    err = stv0910_read_regs (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_ISYMB : RSTV0910_P1_ISYMB, 2, buff) ;	// ISYMB, QSYMB
+    *i = buff [0] ;
+    *q = buff [1] ;
 	
     if (err != ERROR_NONE) printf ("ERROR: STV0910 read constellation\n");
 
@@ -370,26 +395,17 @@ uint8_t stv0910_read_sr (uint8_t tunerdemod, uint32_t *found_sr)
 	double 		sr ;
     uint8_t 	val_h, val_mu, val_ml, val_l ;
     uint8_t 	err = ERROR_NONE ;
-    uint8_t		tempc ;
+    uint8_t		buff [7] ;
 	int32_t		temp ;
 	double		tempf ;
 
-    err = stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_SFR3 : RSTV0910_P1_SFR3, &val_h) ;  		/* high byte */
-    
-	if (err == ERROR_NONE) 
-	{
-		err = stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_SFR2 : RSTV0910_P1_SFR2, &val_mu); 	/* mid upper */
-	}
-    
-	if (err == ERROR_NONE) 
-	{
-		err = stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_SFR1 : RSTV0910_P1_SFR1, &val_ml); 	/* mid lower */
-	}
-	
-    if (err == ERROR_NONE) 
-	{
-		err = stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_SFR0 : RSTV0910_P1_SFR0, &val_l);  	/* low byte */
-    }
+// SFR3, SFR2, SFR1, SFR0, TMGREG2, TMGREG1, TMGREG0 are read together
+
+    err = stv0910_read_regs (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_SFR3 : RSTV0910_P1_SFR3, 7, buff) ;
+    val_h  = buff [0] ;																						/* high byte */
+    val_mu = buff [1] ;																						/* mid upper */
+    val_ml = buff [2] ;																						/* mid lower */
+    val_l  = buff [3] ;																						/* low byte */
 	
 	sr = ((uint32_t)val_h  << 24) +
          ((uint32_t)val_mu << 16) +
@@ -408,29 +424,9 @@ uint8_t stv0910_read_sr (uint8_t tunerdemod, uint32_t *found_sr)
 	temp = 0 ;														// int32_t
     if (err == ERROR_NONE) 
 	{
-	    err  |= stv0910_read_reg 
-	    (
-	    	tunerdemod == STV_TUNER1_DEMOD2 
-	    	? RSTV0910_P2_TMGREG2 : RSTV0910_P1_TMGREG2, 		    /* byte2 */
-	    	&tempc
-	    ) ;  		
-		temp |= tempc << 24 ;
-
-	    err  |= stv0910_read_reg 
-	    (
-	    	tunerdemod == STV_TUNER1_DEMOD2 
-	    	? RSTV0910_P2_TMGREG1 : RSTV0910_P1_TMGREG1, 		    /* byte1 */
-	    	&tempc
-	    ) ;  		
-		temp |= tempc << 16 ;
-
-	    err  |= stv0910_read_reg 
-	    (
-	    	tunerdemod == STV_TUNER1_DEMOD2 
-	    	? RSTV0910_P2_TMGREG0 : RSTV0910_P1_TMGREG0, 		    /* byte0 */
-	    	&tempc
-	    ) ;  		
-		temp |= tempc << 8 ;
+		temp |= buff [4] << 24 ;									/* TMGREG2 */
+		temp |= buff [5] << 16 ;									/* TMGREG1 */
+		temp |= buff [6] << 8 ;										/* TMGREG0 */
 
 		temp = temp / 256 ;											// move to the bottom 24 bits 
 																	// and extend the sign
@@ -486,15 +482,13 @@ uint8_t stv0910_read_puncture_rate (uint8_t tunerdemod, uint8_t *rate)
 uint8_t stv0910_read_power (uint8_t tunerdemod, uint8_t *power_i, uint8_t *power_q) 
 {
     uint8_t 	err;
+    uint8_t		buff [2] ;
 
 /* power = 1/4 . ADC */
 
-	err = stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_POWERI : RSTV0910_P1_POWERI, power_i) ;
-
-	if (err == ERROR_NONE)
-	{
-		err = stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_POWERQ : RSTV0910_P1_POWERQ, power_q) ;
-	}
+	err = stv0910_read_regs (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_POWERI : RSTV0910_P1_POWERI, 2, buff) ;	// POWERI, POWERQ
+	*power_i = buff [0] ;
+	*power_q = buff [1] ;
 
     if (err != ERROR_NONE) printf ("ERROR: STV0910 read power\r\n");
 
@@ -540,49 +534,26 @@ uint8_t stv0910_read_ber (uint8_t tunerdemod, uint32_t *ber)
 {
     uint8_t 	err ;
     uint8_t 	high, mid_u, mid_m, mid_l, low ;
+    uint8_t		buff [8] ;
     double 		cpt ;
     double 		errs ;
 
-/* first we trigger a buffer transfer and read the byte counter 40 bits */
-
-    err = stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_FBERCPT4 : RSTV0910_P1_FBERCPT4, &high) ;
+/* reading FBERCPT4 triggers a buffer transfer; the byte counter (40 bits) and the bit error count */
+/* (24 bits) that follow it are read in the same burst                                              */
 
-    if (err == ERROR_NONE) 
-	{
-		err = stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_FBERCPT3 : RSTV0910_P1_FBERCPT3, &mid_u) ;
-    }
-	
-	if (err == ERROR_NONE) 
-	{
-		err = stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_FBERCPT2 : RSTV0910_P1_FBERCPT2, &mid_m) ;
-	}
-	
-    if (err == ERROR_NONE) 
-	{
-		err = stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_FBERCPT1 : RSTV0910_P1_FBERCPT1, &mid_l) ;
-	}
-	
-    if (err == ERROR_NONE) 
-	{
-		err = stv0910_read_reg(tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_FBERCPT0 : RSTV0910_P1_FBERCPT0, &low) ;
-	}
+    err = stv0910_read_regs (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_FBERCPT4 : RSTV0910_P1_FBERCPT4, 8, buff) ;
+    high  = buff [0] ;
+    mid_u = buff [1] ;
+    mid_m = buff [2] ;
+    mid_l = buff [3] ;
+    low   = buff [4] ;
 	
     cpt = 	(double) high  * 256.0 * 256.0 * 256.0 * 256.0 + (double) mid_u * 256.0 * 256.0 * 256.0 + 
 			(double) mid_m * 256.0 * 256.0 + (double) mid_l * 256.0 + (double)low;
 
-/* we have already triggered the register buffer transfer, so now we we read the bit error from them */
-
-    err = stv0910_read_reg(tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_FBERERR2 : RSTV0910_P1_FBERERR2, &high) ;
-	
-    if (err == ERROR_NONE) 
-	{
-		err = stv0910_read_reg(tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_FBERERR1 : RSTV0910_P1_FBERERR1, &mid_m) ;
-	}
-	
-    if (err == ERROR_NONE) 
-	{
-		err = stv0910_read_reg(tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_FBERERR0 : RSTV0910_P1_FBERERR0, &low) ;
-	}
+    high  = buff [5] ;																	/* FBERERR2 */
+    mid_m = buff [6] ;																	/* FBERERR1 */
+    low   = buff [7] ;																	/* FBERERR0 */
     
 	errs = (double) high * 256.0 * 256.0 + (double) mid_m * 256.0 + (double) low ;
     *ber = (uint32_t)(10000.0 * errs / (cpt * 8.0)) ;
@@ -602,14 +573,12 @@ uint8_t stv0910_read_mer (uint8_t tunerdemod, int32_t *mer)
 {
     uint8_t 	err ;
     uint8_t		high, low ;
+    uint8_t		buff [2] ;
 	int32_t		temp ;
 
-    err = stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_NOSRAMPOS : RSTV0910_P1_NOSRAMPOS, &high) ;
-    
-	if (err == ERROR_NONE) 
-	{
-		err = stv0910_read_reg (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_NOSRAMVAL : RSTV0910_P1_NOSRAMVAL, &low) ;
-    }
+    err = stv0910_read_regs (tunerdemod == STV_TUNER1_DEMOD2 ? RSTV0910_P2_NOSRAMPOS : RSTV0910_P1_NOSRAMPOS, 2, buff) ;	// NOSRAMPOS, NOSRAMVAL
+    high = buff [0] ;
+    low  = buff [1] ;
 
     if (((high >> 2) & 0x01) == 1)					/* Px_NOSRAM_CNRVAL is valid */
 	{
@@ -699,17 +668,15 @@ uint8_t stv0910_read_errors_bch_count (uint8_t tunerdemod, uint32_t *errors_bch_
 uint8_t stv0910_read_errors_ldpc_count (uint8_t tunerdemod, uint32_t *errors_ldpc_count) 
 {
     uint8_t	 	err ;
-    uint8_t 	high, low ;
+    uint8_t 	buff [2] ;
 
 /* This parameter appears to be total, not for an individual demodulator */
 
     (void) tunerdemod ;
 
-	err = stv0910_read_reg_field (FSTV0910_LDPC_ERRORS1, &high) ;
-
-    if (err == ERROR_NONE) err = stv0910_read_reg_field(FSTV0910_LDPC_ERRORS0, &low) ;
+	err = stv0910_read_regs (FSTV0910_LDPC_ERRORS1 >> 16, 2, buff) ;		// LDPC_ERRORS1, LDPC_ERRORS0 are whole registers
 
-    *errors_ldpc_count = (uint32_t)high << 8 | (uint32_t)low;
+    *errors_ldpc_count = (uint32_t)buff [0] << 8 | (uint32_t)buff [1];
 
     if (err != ERROR_NONE) printf("ERROR: STV0910 read LDPC Errors Count\n");
 
@@ -1128,6 +1095,17 @@ uint8_t stv0910_init_regs()
 {
     uint8_t 	err ;
     uint16_t 	i ;
+    uint16_t 	run ;
+    uint16_t 	reg ;
+    uint16_t 	lastreg 	= 0 ;
+    bool 		single ;
+    bool 		lastsingle 	= true ;
+    bool 		autoinc ;
+
+static	uint16_t	initruns = 0 ;
+static	uint16_t	initrunstart  [STV0910_NBREGS] ;				// first list entry of each run
+static	uint16_t	initrunlength [STV0910_NBREGS] ;
+static	uint8_t		initvals 	  [STV0910_NBREGS] ;				// list values, contiguous for the bursts
 
     printf ("Flow: stv0910 init regs\r\n") ;
 
@@ -1148,14 +1126,57 @@ uint8_t stv0910_init_regs()
     }
 */
 
-/* next we initialise all the registers in the list */
+/* next we initialise all the registers in the list, all of which are written whatever the shadow holds */
+
+	stv0910_shadow_invalidate () ;
 
-	i = 0 ;
-    do 
+/* the list is grouped, on first use, into runs of consecutive addresses, each of which is written  */
+/* in one burst using the auto increment. The registers which control the i2c interface itself are  */
+/* written singly, and no burst is used until I2CCFG has enabled the auto increment.                 */
+
+	if (initruns == 0)
+	{
+		autoinc = false ;
+		i 		= 0 ;
+		do 
+		{
+			reg = STV0910DefVal[i].reg ;
+			initvals [i] = STV0910DefVal[i].val ;
+			single = !autoinc || (reg == RSTV0910_I2CCFG) || (reg == RSTV0910_P1_I2CRPT) || (reg == RSTV0910_P2_I2CRPT) ;
+
+			if (initruns && !single && !lastsingle && (reg == lastreg + 1) && (initrunlength [initruns - 1] < STV0910_MAXBURST))
+			{
+				initrunlength [initruns - 1]++ ;						// extend the current run
+			}
+			else
+			{
+				initrunstart  [initruns] = i ;							// start a new run
+				initrunlength [initruns] = 1 ;
+				initruns++ ;
+			}
+
+			if (reg == RSTV0910_I2CCFG)
+			{
+				autoinc = true ;
+			}
+			lastreg 	= reg ;
+			lastsingle 	= single ;
+		}        
+		while (STV0910DefVal[i++].reg != RSTV0910_TSTTSRS) ;
+	}
+
+	for (run = 0 ; run < initruns ; run++)
 	{
-		if (err == ERROR_NONE) err = stv0910_write_reg (STV0910DefVal[i].reg, STV0910DefVal[i].val) ;
-    }        
-    while (STV0910DefVal[i++].reg != RSTV0910_TSTTSRS) ;
+		i = initrunstart [run] ;
+		if (initrunlength [run] == 1)
+		{
+			if (err == ERROR_NONE) err = stv0910_write_reg (STV0910DefVal[i].reg, initvals [i]) ;
+		}
+		else
+		{
+			if (err == ERROR_NONE) err = stv0910_write_regs (STV0910DefVal[i].reg, initrunlength [run], &initvals [i]) ;
+		}
+	}
 
 /* finally (from ST example code) reset the LDPC decoder */
 
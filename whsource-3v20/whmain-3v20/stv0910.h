@@ -80,6 +80,7 @@
 	uint8_t stv0910_read_rolloff					(uint8_t, uint32_t*) ;
 	uint8_t stv0910_init							(void) ;
 	uint8_t stv0910_setup_receive					(uint32_t, uint32_t, int32_t);
+	uint8_t stv0910_retune_receive					(uint32_t, uint32_t, int32_t, bool);
 	uint8_t stv0910_init_regs						(void);
 	uint8_t stv0910_setup_timing_loop				(uint8_t, uint32_t);
 	uint8_t stv0910_setup_carrier_loop				(uint8_t, uint32_t, uint32_t); 
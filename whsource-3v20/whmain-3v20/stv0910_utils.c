@@ -27,13 +27,21 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
+#include <stdbool.h>
 #include "stv0910_regs.h"
 #include "stv0910_utils.h"
 #include "errors.h"
 #include "nim.h"
 
 /* in order to do bitfields efficiently, we need to keep a shadow register set */
-uint8_t stv0910_shadow_regs[STV0910_END_ADDR - STV0910_START_ADDR + 1];
+/* WinterHill: there is one set for each NIM, indexed by GLOBALNIM (1 to 4), and each register has a */
+/* valid flag so that a write of the value already in the chip can be skipped                        */
+extern uint32_t GLOBALNIM;
+
+uint8_t stv0910_shadow_regs[5][STV0910_END_ADDR - STV0910_START_ADDR + 1];
+uint8_t stv0910_shadow_valid[5][STV0910_END_ADDR - STV0910_START_ADDR + 1];
+uint32_t stv0910_writes_skipped;
 
 /* -------------------------------------------------------------------------------------------------- */
 /* ----------------- ROUTINES ----------------------------------------------------------------------- */
@@ -53,13 +61,20 @@ uint8_t stv0910_write_reg_field(uint32_t field, uint8_t field_val) {
 
     /* firsr we need to work out which register to use */
     reg=field >> 16;
+    /* if the shadow has not been written yet, it has to be loaded from the chip */
+    if (!stv0910_shadow_valid[GLOBALNIM][reg-STV0910_START_ADDR]) {
+        err=nim_read_demod(reg, &val);
+        if (err==ERROR_NONE) {
+            stv0910_shadow_regs[GLOBALNIM][reg-STV0910_START_ADDR]=val;
+            stv0910_shadow_valid[GLOBALNIM][reg-STV0910_START_ADDR]=1;
+        }
+    }
     /* now we calculate the new value for this reg by reading the shadow array, */
     /*  masking out the field we want, and putting the new value in             */
-    val=((stv0910_shadow_regs[reg-STV0910_START_ADDR] & ~(field & 0xff)) |
+    val=((stv0910_shadow_regs[GLOBALNIM][reg-STV0910_START_ADDR] & ~(field & 0xff)) |
          (field_val << ((field >> 12) & 0x0f))        );
     /* now we can write the new value back to the demodulator and the shadow registers */
-    if (err==ERROR_NONE) err=nim_write_demod(reg, val);
-    if (err==ERROR_NONE) stv0910_shadow_regs[reg-STV0910_START_ADDR]=val;
+    if (err==ERROR_NONE) err=stv0910_write_reg(reg, val);
 
     if (err!=ERROR_NONE) printf("ERROR: STV0910 write field\n");
 
@@ -91,12 +106,66 @@ uint8_t stv0910_read_reg_field(uint32_t field, uint8_t *field_val) {
 uint8_t stv0910_write_reg(uint16_t reg, uint8_t val) {
 /* -------------------------------------------------------------------------------------------------- */
 /* abstracts a hardware register write to the stv0910                                                 */
+/* the write is skipped if the shadow shows that the register already holds the value                 */
+/*    return: error code                                                                              */
+/* -------------------------------------------------------------------------------------------------- */
+    uint8_t err;
+    uint16_t index;
+
+    index=reg-STV0910_START_ADDR;
+    if (stv0910_shadow_valid[GLOBALNIM][index] && (stv0910_shadow_regs[GLOBALNIM][index]==val) &&
+        !stv0910_reg_is_command(reg)) {
+        stv0910_writes_skipped++;
+        return ERROR_NONE;
+    }
+
+    err=nim_write_demod(reg, val);
+    stv0910_shadow_regs[GLOBALNIM][index]=val;
+    stv0910_shadow_valid[GLOBALNIM][index]=(err==ERROR_NONE);
+
+    return err;
+}
+
+/* -------------------------------------------------------------------------------------------------- */
+uint8_t stv0910_write_regs(uint16_t reg, uint16_t n, uint8_t *val) {
+/* -------------------------------------------------------------------------------------------------- */
+/* writes n consecutive stv0910 registers in one burst and updates their shadow registers together    */
 /*    return: error code                                                                              */
 /* -------------------------------------------------------------------------------------------------- */
 
-    stv0910_shadow_regs[reg-STV0910_START_ADDR]=val;
+    uint8_t err;
+
+    err=nim_write_demod_block(reg, n, val);
+    memcpy(&stv0910_shadow_regs[GLOBALNIM][reg-STV0910_START_ADDR], val, n);
+    memset(&stv0910_shadow_valid[GLOBALNIM][reg-STV0910_START_ADDR], err==ERROR_NONE, n);
+
+    return err;
+}
+
+/* -------------------------------------------------------------------------------------------------- */
+void stv0910_shadow_invalidate(void) {
+/* -------------------------------------------------------------------------------------------------- */
+/* forgets the shadow registers of the current NIM, so that every register is written next time      */
+/* -------------------------------------------------------------------------------------------------- */
+
+    memset(stv0910_shadow_valid[GLOBALNIM], 0, sizeof(stv0910_shadow_valid[GLOBALNIM]));
+}
+
+/* -------------------------------------------------------------------------------------------------- */
+bool stv0910_reg_is_command(uint16_t reg) {
+/* -------------------------------------------------------------------------------------------------- */
+/* registers where the write itself does something (start a search, reset a block, re-arm the MER    */
+/* estimator), or whose meaning depends on an index written to another register, so a write of the    */
+/* same value must never be skipped                                                                   */
+/* -------------------------------------------------------------------------------------------------- */
 
-    return nim_write_demod(reg, val) ;
+    return (reg==RSTV0910_P1_DMDISTATE) || (reg==RSTV0910_P2_DMDISTATE) ||
+           (reg==RSTV0910_P1_PDELCTRL1) || (reg==RSTV0910_P2_PDELCTRL1) ||
+           (reg==RSTV0910_P1_TSCFGH)    || (reg==RSTV0910_P2_TSCFGH)    ||
+           (reg==RSTV0910_P1_NOSRAMCFG) || (reg==RSTV0910_P2_NOSRAMCFG) ||
+           (reg==RSTV0910_P1_ISIENTRY)  || (reg==RSTV0910_P2_ISIENTRY)  ||   /* selects the ISI . . */
+           (reg==RSTV0910_P1_ISIBITENA) || (reg==RSTV0910_P2_ISIBITENA) ||   /* . . this one enables */
+           (reg==RSTV0910_TSTRES0);
 }
 
 /* -------------------------------------------------------------------------------------------------- */
@@ -109,3 +178,13 @@ uint8_t stv0910_read_reg(uint16_t reg, uint8_t *val) {
     return nim_read_demod(reg, val);
 }
 
+/* -------------------------------------------------------------------------------------------------- */
+uint8_t stv0910_read_regs(uint16_t reg, uint16_t n, uint8_t *val) {
+/* -------------------------------------------------------------------------------------------------- */
+/* reads n consecutive stv0910 registers in one burst, so multi-byte values are read together         */
+/*    return: error code                                                                              */
+/* -------------------------------------------------------------------------------------------------- */
+
+    return nim_read_demod_block(reg, n, val);
+}
+
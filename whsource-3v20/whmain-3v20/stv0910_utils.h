@@ -22,13 +22,22 @@
 #ifndef STV0910_UTILS_H
 #define STV0910_UTILS_H
 
+#include <stdbool.h>
+
 #define STV0910_START_ADDR RSTV0910_MID
 #define STV0910_END_ADDR RSTV0910_TSTTSRS
+#define STV0910_MAXBURST 64 /* registers in one burst write, no more than I2CMAXBURST */
 
 uint8_t stv0910_write_reg_field(uint32_t, uint8_t);
 uint8_t stv0910_read_reg_field(uint32_t, uint8_t *);
 uint8_t stv0910_write_reg(uint16_t, uint8_t);
+uint8_t stv0910_write_regs(uint16_t, uint16_t, uint8_t *);
+void stv0910_shadow_invalidate(void);
+bool stv0910_reg_is_command(uint16_t);
+
+extern uint32_t stv0910_writes_skipped;
 uint8_t stv0910_read_reg(uint16_t, uint8_t *);
+uint8_t stv0910_read_regs(uint16_t, uint16_t, uint8_t *);
 
 #endif
 
@@ -182,14 +182,7 @@ uint8_t stv6120_init (uint32_t nimtuner, uint32_t freq_tuner, uint32_t antenna,
             ) ; 
         }    
 
-    	if (symbolrate == 27500 || symbolrate == 22000)
-    	{
-			temp = STV6120_CTRL7_CF_23MHZ ;
-    	}
-    	else
-    	{
-			temp = STV6120_CTRL7_CF_5MHZ ;
-    	}
+		temp = stv6120_filter_cf (symbolrate) ;
         if (err == ERROR_NONE) 
         {
             ctrl7 	= (STV6120_CTRL7_RCCLKOFF_DISABLE << STV6120_CTRL7_RCCLKOFF_SHIFT) |
@@ -242,14 +235,7 @@ uint8_t stv6120_init (uint32_t nimtuner, uint32_t freq_tuner, uint32_t antenna,
             ) ;
 		}
 
-    	if (symbolrate == 27500 || symbolrate == 22000)
-    	{
-			temp = STV6120_CTRL7_CF_23MHZ ;
-    	}
-    	else
-    	{
-			temp = STV6120_CTRL7_CF_5MHZ ;
-    	}
+		temp = stv6120_filter_cf (symbolrate) ;
         if (err == ERROR_NONE) 
         {
             ctrl16 	= (STV6120_CTRL7_RCCLKOFF_DISABLE << STV6120_CTRL7_RCCLKOFF_SHIFT) |
@@ -353,6 +339,80 @@ uint8_t stv6120_init (uint32_t nimtuner, uint32_t freq_tuner, uint32_t antenna,
 }
 
 
+/* -------------------------------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------------------------------- */
+/* Returns the lowpass filter cutoff (CTRL7_CF) used for a symbol rate                                */
+/*                                                                                                    */
+/*   symbolrate:	kS                                                                                */
+/*       return:	STV6120_CTRL7_CF_xxx                                                              */
+/* -------------------------------------------------------------------------------------------------- */
+
+uint8_t stv6120_filter_cf (uint32_t symbolrate) 
+{
+   	if (symbolrate == 27500 || symbolrate == 22000)
+   	{
+		return (STV6120_CTRL7_CF_23MHZ) ;
+   	}
+	return (STV6120_CTRL7_CF_5MHZ) ;
+}
+
+
+/* -------------------------------------------------------------------------------------------------- */
+/* -------------------------------------------------------------------------------------------------- */
+/* Retunes a tuner which has already been set up by stv6120_init with the same antenna.              */
+/* The common clock, paths and test registers are left alone. The lowpass filter is only            */
+/* recalibrated if its cutoff has changed.                                                            */
+/*                                                                                                    */
+/*   nimtuner:  		TUNER_1  |  TUNER_2                                                           */
+/*   freq_tuner:  		kHz                                                                           */
+/*   symbolrate:		kS, to set the lowpass filter cutoff                                          */
+/*   recal:				the cutoff has changed, so write it and recalibrate the filter               */
+/* return: error code                                                                                 */
+/* -------------------------------------------------------------------------------------------------- */
+
+uint8_t stv6120_retune (uint32_t nimtuner, uint32_t freq_tuner, uint32_t symbolrate, bool recal) 
+{
+    uint8_t     err     = ERROR_NONE ;
+    uint8_t		ctrl ;
+
+    printf ("Flow: Tuner%d retune %d\r\n",nimtuner,freq_tuner) ;
+
+// ctrl7 and ctrl16 are shared by all the NIMs, so set them up for this one
+
+	ctrl = (STV6120_CTRL7_RCCLKOFF_DISABLE   << STV6120_CTRL7_RCCLKOFF_SHIFT) |
+		   (stv6120_filter_cf (symbolrate) << STV6120_CTRL7_CF_SHIFT) ;
+	if (nimtuner == TUNER_1)
+	{
+		ctrl7  = ctrl ;
+	}
+	else
+	{
+		ctrl16 = ctrl ;
+	}
+
+	if (recal)
+	{
+        err = stv6120_write_reg (nimtuner == TUNER_1 ? STV6120_CTRL7 : STV6120_CTRL16, ctrl) ;
+        if (err == ERROR_NONE) 
+        {
+        	err = stv6120_cal_lowpass (nimtuner) ;
+        }
+	}
+
+    if (err == ERROR_NONE) 
+    {
+        err = stv6120_set_freq (nimtuner, freq_tuner) ;
+    }
+    
+    if (err != ERROR_NONE) 
+    {
+        printf ("ERROR: Failed to retune Tuner%i, %i\r\n",nimtuner, freq_tuner) ;
+    }
+    
+    return (err) ;
+}
+
+
 /* -------------------------------------------------------------------------------------------------- */
 /* -------------------------------------------------------------------------------------------------- */
 /* -------------------------------------------------------------------------------------------------- */
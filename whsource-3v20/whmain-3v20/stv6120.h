@@ -24,6 +24,7 @@
 	#define STV6120_H
 
 	#include <stdint.h>
+	#include <stdbool.h>
 
 	#define TUNER_LOCKED     			0
 	#define TUNER_NOT_LOCKED 			1
@@ -43,6 +44,8 @@
 
 	uint8_t 	stv6120_init			(uint32_t, uint32_t, uint32_t, uint32_t) ;
 	uint8_t 	stv6120_set_freq		(uint8_t, uint32_t);
+	uint8_t 	stv6120_retune			(uint32_t, uint32_t, uint32_t, bool) ;
+	uint8_t 	stv6120_filter_cf		(uint32_t) ;
 	uint8_t 	stv6120_cal_lowpass		(uint8_t);
 	void 		stv6120_print_settings	(void) ;
 	
@@ -185,5 +185,7 @@
 /* vco 2 amplfier and test */
 #define STV6120_CTRL23 0x18
 
+#define STV6120_NBREGS 0x19
+
 #endif
 
@@ -9,7 +9,19 @@
 /* ----------------- INCLUDES ----------------------------------------------------------------------- */
 /* -------------------------------------------------------------------------------------------------- */
 
+#include <string.h>
 #include "nim.h"
+#include "stv6120_regs.h"
+#include "stv6120_utils.h"
+#include "errors.h"
+
+/* WinterHill: a shadow of the tuner registers for each NIM, indexed by GLOBALNIM (1 to 4), so that  */
+/* a write of the value already in the chip can be skipped                                           */
+extern uint32_t GLOBALNIM;
+
+uint8_t stv6120_shadow_regs[5][STV6120_NBREGS];
+uint8_t stv6120_shadow_valid[5][STV6120_NBREGS];
+uint32_t stv6120_writes_skipped;
 
 /* -------------------------------------------------------------------------------------------------- */
 /* ----------------- ROUTINES ----------------------------------------------------------------------- */
@@ -27,6 +39,33 @@ uint8_t stv6120_read_reg(uint8_t reg, uint8_t *val) {
 uint8_t stv6120_write_reg(uint8_t reg, uint8_t val) {
 /* -------------------------------------------------------------------------------------------------- */
 /* passes the register write through to the underlying register writing routines                      */
+/* the write is skipped if the shadow shows that the register already holds the value. STAT1 and     */
+/* STAT2 start the calibrations, so they are always written                                           */
+/* -------------------------------------------------------------------------------------------------- */
+    uint8_t err;
+
+    if (reg >= STV6120_NBREGS) {
+        return nim_write_tuner(reg, val);
+    }
+
+    if (stv6120_shadow_valid[GLOBALNIM][reg] && (stv6120_shadow_regs[GLOBALNIM][reg]==val) &&
+        (reg!=STV6120_STAT1) && (reg!=STV6120_STAT2)) {
+        stv6120_writes_skipped++;
+        return ERROR_NONE;
+    }
+
+    err=nim_write_tuner(reg, val);
+    stv6120_shadow_regs[GLOBALNIM][reg]=val;
+    stv6120_shadow_valid[GLOBALNIM][reg]=(err==ERROR_NONE);
+
+    return err;
+}
+
 /* -------------------------------------------------------------------------------------------------- */
-    return nim_write_tuner(reg, val);
+void stv6120_shadow_invalidate(void) {
+/* -------------------------------------------------------------------------------------------------- */
+/* forgets the tuner shadow registers of the current NIM, so that every register is written next time */
+/* -------------------------------------------------------------------------------------------------- */
+
+    memset(stv6120_shadow_valid[GLOBALNIM], 0, sizeof(stv6120_shadow_valid[GLOBALNIM]));
 }
@@ -26,6 +26,9 @@
 
 uint8_t stv6120_read_reg(uint8_t, uint8_t *);
 uint8_t stv6120_write_reg(uint8_t, uint8_t);
+void stv6120_shadow_invalidate(void);
+
+extern uint32_t stv6120_writes_skipped;
 
 #endif
 